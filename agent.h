@@ -17,8 +17,14 @@
 #include <fstream>
 #include <assert.h>
 #include <chrono>
+#include <memory>
 #include "board.h"
 #include "action.h"
+#include "pattern.h"
+#include "ntuple.h"
+#include "nn.h"
+#include "trace.h"
+#include "alloc.h"
 
 class agent {
 public:
@@ -63,11 +69,92 @@ public:
 			engine.seed(int(meta["seed"]));
 	}
 	virtual ~random_agent() {}
+	void reseed(unsigned seed) { engine.seed(seed); }
 
 protected:
 	std::default_random_engine engine;
 };
 
+/**
+ * selection policies of the search tree
+ * the policy is a template parameter of Node so that scoring is inlined into the descent
+ *
+ * prepare(parent) is called once before the children of parent are scored
+ * score(child) returns the priority of child, the child with the highest score is selected
+ * unvisited_first indicates whether an unvisited child is selected immediately
+ */
+struct ucb1 {
+	static constexpr bool unvisited_first = true;
+	double c = 0.25;
+	double log_n = 0;
+	template<typename node> void prepare(const node& parent) { log_n = log2(parent.visits); }
+	template<typename node> double score(const node& child) {
+		return child.wins / child.visits + c * sqrt(log_n / child.visits);
+	}
+};
+
+/**
+ * UCB1-Tuned, the exploration term is bounded by the variance of the win rate
+ * since the rewards are either 0 or 1, the variance is derived from the win rate directly
+ */
+struct ucb1_tuned {
+	static constexpr bool unvisited_first = true;
+	double c = 1;
+	double ln_n = 0;
+	template<typename node> void prepare(const node& parent) { ln_n = log(parent.visits); }
+	template<typename node> double score(const node& child) {
+		double mean = child.wins / child.visits;
+		double bound = mean - mean * mean + sqrt(2 * ln_n / child.visits);
+		return mean + c * sqrt(ln_n / child.visits * std::min(0.25, bound));
+	}
+};
+
+/**
+ * PUCT, the exploration term is weighted by the prior of the child, given by the pattern weights
+ * unvisited children are valued as losses, and thus are ordered by their priors
+ */
+struct puct {
+	static constexpr bool unvisited_first = false;
+	double c = 1;
+	double sqrt_n = 0;
+	template<typename node> void prepare(const node& parent) { sqrt_n = sqrt(parent.visits); }
+	template<typename node> double score(const node& child) {
+		double mean = child.visits ? child.wins / child.visits : 0;
+		return mean + c * child.prior * sqrt_n / (1 + child.visits);
+	}
+};
+
+/**
+ * Thompson sampling, the win rate of each child is sampled from Beta(wins + 1, losses + 1)
+ * the counts are divided by c, i.e., a larger c flattens the posterior for more exploration
+ */
+struct thompson {
+	static constexpr bool unvisited_first = false;
+	double c = 1;
+	std::default_random_engine engine;
+	template<typename node> void prepare(const node& parent) {}
+	template<typename node> double score(const node& child) {
+		std::gamma_distribution<double> win(child.wins / c + 1), loss((child.visits - child.wins) / c + 1);
+		double x = win(engine), y = loss(engine);
+		return x / (x + y);
+	}
+};
+
+/**
+ * rollout policy that plays uniformly random legal moves
+ */
+struct random_rollout {
+	void reset(const board& b) {}
+	bool step(board& b) {
+		board::point point = b.get_random_legal_pt(engine);
+		if (point.x == -1 && point.y == -1) return false;
+		b.place(point.x, point.y);
+		return true;
+	}
+	std::default_random_engine engine;
+};
+
+template<typename selection>
 class Node {
 public:
 	Node( size_t who ) : parent(nullptr), who(who), pos(), children() {}
@@ -79,19 +166,17 @@ public:
 	}
 	const Node* get_parent() const { return parent; };
 
-	Node* getBestChild() {
-		// std::vector<double> scores;
+	Node* getBestChild(selection& select) {
 		Node* bestChild = nullptr;
-		double max_score = -1;
-		double log2visits = log2( visits );
+		double max_score = std::numeric_limits<double>::lowest();
+		select.prepare(*this);
 		for (auto& child : children) {
-			// selection with standard UCB
-			if (child->visits == 0){
+			if (selection::unvisited_first && child->visits == 0){
 			 	child->ucb = std::numeric_limits<double>::max();
 				return child;
 			}
 			else{
-				child->ucb = child->wins / child->visits + 0.25 * sqrt(log2visits / child->visits);
+				child->ucb = select.score(*child);
 			}
 
 			if( child->ucb > max_score ){
@@ -126,9 +211,13 @@ public:
 			return false;
 		}
 
-		// expand children
+		// expand children, with priors proportional to the pattern weights
+		const pattern::table& weights = pattern::weights(3u-who);
+		double sum = 0;
+		for (auto& point : points) sum += weights[pattern::at(after, point.x, point.y)];
 		for (auto& point : points) {
 			Node* child = new Node( this, 3u-who, point);
+			child->prior = weights[pattern::at(after, point.x, point.y)] / sum;
 			// std::cout<<"child:"<<child->pos<<", parent: "<<child->parent->pos<<std::endl;
 			children.emplace_back(child);
 		}
@@ -142,48 +231,102 @@ public:
 		return true;
 	}
 
-	Node* traverse( board& state ) {
+	/**
+	 * expand all legal moves of a leaf at once regardless of its visits, with uniform priors
+	 * return false if there is no legal move
+	 */
+	bool expandAll(const board& state) {
+		if( is_expanded ) return true;
+		if( is_leaf ) return false;
+		std::vector<board::point> points = board(state).get_legal_pts();
+		if (points.empty()){
+			is_leaf = true;
+			return false;
+		}
+		for (auto& point : points) {
+			Node* child = new Node( this, 3u-who, point);
+			child->prior = 1.0 / points.size();
+			children.emplace_back(child);
+		}
+		is_expanded = true;
+		return true;
+	}
+
+	/**
+	 * count a pending simulation as a loss for every node till the root,
+	 * so that other simulations of the same batch are steered away from this path
+	 */
+	void addVirtualLoss() {
+		for (Node* node = this; node != nullptr; node = node->parent) node->visits++;
+	}
+	void revertVirtualLoss() {
+		for (Node* node = this; node != nullptr; node = node->parent) node->visits--;
+	}
+
+	Node* traverse( board& state, selection& select ) {
 		Node* node = this;
 		while( node->children.size() > 0 ){
 		// while( node->is_fully_expanded() ){
-			node = node->getBestChild();
+			node = node->getBestChild(select);
 			assert(state.place(node->pos) == board::legal);
 		}
 		return node;
 	}
 
-	Node* treePolicy(board& state) {
+	Node* treePolicy(board& state, selection& select) {
 		//selection
-		Node* cur = this->traverse(state);
+		Node* cur = this->traverse(state, select);
 
 		//expansion
 		if(cur->expand(state)){
-			cur = cur->getBestChild();
+			cur = cur->getBestChild(select);
 			assert(state.place( cur->pos ) == board::legal);
 		}
 		return cur;
 	}
 
-	size_t defaultPolicy( const board& state ) {
+	template<typename rollout>
+	size_t defaultPolicy( const board& state, rollout& play ) {
 		board after  = board(state);
+		play.reset(after);
 		size_t cur_who = 3u-who;
-		while ( true ) {
-			// std::cout<<state<<std::endl;
-			board::point point = after.get_random_legal_pt( );
-			// std::cout<<"default policy : "<<point.x<<","<<point.y<<std::endl;
-			if( point.x == -1 && point.y == -1 ) return 3u-cur_who;
-			after.place( point.x, point.y );
+		while ( play.step(after) ) {
 			cur_who = 3u-cur_who;
 		}
+		return 3u-cur_who;
 	}
 	
 
+	/**
+	 * play at most depth plies by the rollout policy, then estimate the result by the evaluator
+	 * unless the game is over, i.e., the side to play has no legal move and loses
+	 * return the chance that black wins
+	 */
+	template<typename rollout, typename evaluator>
+	double defaultPolicy( const board& state, rollout& play, const evaluator& eval, int depth ) {
+		board after  = board(state);
+		play.reset(after);
+		for ( int ply = 0; ply < depth; ply++ ) {
+			if ( !play.step(after) ) return after.info().who_take_turns == board::black ? 0 : 1;
+		}
+		if ( after.get_legal_pts().empty() ) return after.info().who_take_turns == board::black ? 0 : 1;
+		double p = eval.estimate(after);
+		return after.info().who_take_turns == board::black ? p : 1 - p;
+	}
+
 	void backPropagate( size_t winner) {
+		backPropagateScore( winner == board::black ? 1 : 0 );
+	}
+
+	/**
+	 * back propagate a fractional result, given as the chance that black wins
+	 */
+	void backPropagateScore( double score ) {
 		// back propagate the result till the root
 		Node* node = this;
 		while (node != nullptr) {
 			node->visits++;
-			node->wins += winner == node->who? 1 : 0;
+			node->wins += node->who == board::black ? score : 1 - score;
 			node = node->parent;
 		}
 	}
@@ -193,6 +336,7 @@ public:
 	double visits = 0;
 	double wins = 0;
 	double ucb = 0;
+	double prior = 1;
 	// long unsigned int expanded_count = 0;
 	size_t who;
 	board::point pos;
@@ -200,10 +344,54 @@ public:
 	bool is_leaf = false, is_expanded = false;
 };
 
+/**
+ * statistics of a search, where the time spent in each phase is in seconds
+ * nodes is the size of the tree at the end of the search, which is also its peak
+ */
+struct search_stats {
+	size_t simulations = 0;
+	size_t nodes = 0, depth = 0;
+	double selection = 0, expansion = 0, simulation = 0, backpropagation = 0;
+	double elapsed = 0;
+	alloc_stats allocs[4] = {}; // of each phase, counted only if compiled with -DALLOC_STATS
+
+	/**
+	 * the format is
+	 * sims = 2000, sims/s = 15837.2, nodes = 10563, depth = 7, phases = 1.2%|2.1%|96.5%|0.1%
+	 * where the phases are selection, expansion, simulation, and backpropagation, in the share of elapsed
+	 */
+	friend std::ostream& operator <<(std::ostream& out, const search_stats& stats) {
+		double elapsed = std::max(stats.elapsed, 1e-9);
+		out << "sims = " << stats.simulations << ", ";
+		out << "sims/s = " << (stats.simulations / elapsed) << ", ";
+		out << "nodes = " << stats.nodes << ", ";
+		out << "depth = " << stats.depth << ", ";
+		out << "phases = " << (stats.selection * 100 / elapsed) << "%"
+		    <<        "|" << (stats.expansion * 100 / elapsed) << "%"
+		    <<        "|" << (stats.simulation * 100 / elapsed) << "%"
+		    <<        "|" << (stats.backpropagation * 100 / elapsed) << "%";
+		if (alloc_accounting) {
+			out << ", allocs = " << stats.allocs[0].count << "|" << stats.allocs[1].count
+			    <<          "|" << stats.allocs[2].count << "|" << stats.allocs[3].count;
+			out << ", bytes = " << stats.allocs[0].bytes << "|" << stats.allocs[1].bytes
+			    <<          "|" << stats.allocs[2].bytes << "|" << stats.allocs[3].bytes;
+		}
+		return out;
+	}
+};
+
 /**
  * player for both side
  * random: put a legal piece randomly
  * mcts: use mcts to find the best move
+ *       select=ucb1|ucb1tuned|puct|thompson chooses the selection policy of the tree
+ *       c=<constant> overrides the exploration constant of the selection policy
+ *       log=1 prints the statistics of each search to stderr, see search_stats
+ *       rollout=random|pattern chooses the rollout policy of the simulations
+ *       eval=ntuple load=<path> depth=<plies> estimates the leaves by an n-tuple network
+ *       after at most depth plies of rollout, instead of rolling out until the end
+ *       eval=nn load=<path> batch=<size> evaluates the leaves in batches by a neural network,
+ *       whose policy gives the priors for PUCT and whose value replaces the rollouts
  */
 class player : public random_agent {
    public:
@@ -224,6 +412,37 @@ class player : public random_agent {
 				t_limit = int(meta["time"]);
 			if (meta.find("debug") != meta.end())
 				debug = bool(meta["debug"]);
+			if (meta.find("log") != meta.end())
+				log = bool(meta["log"]);
+			if (meta.find("select") != meta.end())
+				select = std::string(meta["select"]);
+			if (select != "ucb1" && select != "ucb1tuned" && select != "puct" && select != "thompson")
+				throw std::invalid_argument("invalid select: " + select);
+			if (meta.find("c") != meta.end())
+				c = double(meta["c"]);
+			if (c < 0)
+				throw std::invalid_argument("invalid c: " + std::string(meta["c"]));
+			if (meta.find("rollout") != meta.end())
+				rollout = std::string(meta["rollout"]);
+			if (rollout != "random" && rollout != "pattern")
+				throw std::invalid_argument("invalid rollout: " + rollout);
+			if (meta.find("eval") != meta.end() && std::string(meta["eval"]) == "ntuple") {
+				net = std::make_shared<ntuple>();
+				if (meta.find("load") != meta.end())
+					net->load(meta["load"]);
+				else
+					std::cerr << name() << ": eval=ntuple without load=<path>, every position is estimated as even" << std::endl;
+			} else if (meta.find("eval") != meta.end() && std::string(meta["eval"]) == "nn") {
+				nn = std::make_shared<mlp>(engine());
+				if (meta.find("load") != meta.end())
+					nn->load(meta["load"]);
+			} else if (meta.find("eval") != meta.end() && std::string(meta["eval"]) != "rollout") {
+				throw std::invalid_argument("invalid eval: " + std::string(meta["eval"]));
+			}
+			if (meta.find("batch") != meta.end())
+				batch = std::max(1, int(meta["batch"]));
+			if (meta.find("depth") != meta.end())
+				depth = int(meta["depth"]);
 		}
 		else{
 			for (size_t i = 0; i < space.size(); i++)
@@ -232,17 +451,19 @@ class player : public random_agent {
 
     }
 	
-	// just for test
-	void print_tree( Node* root, int depth ){
+	// just for test, printed to stderr so that the GTP stream is intact
+	template<typename selection>
+	void print_tree( Node<selection>* root, int depth ){
 		if( root == nullptr || depth > 2 ) return;
-		for( int i = 0; i < depth; i++ ) std::cout<<"  ";
-		std::cout<<(root->who==1?"B:":"W:")<<root->pos<<"\t"<<root->wins<<"/"<<root->visits<<"\t"<<root->ucb<<root->children.size()<<std::endl;
+		for( int i = 0; i < depth; i++ ) std::cerr<<"  ";
+		std::cerr<<(root->who==1?"B:":"W:")<<root->pos<<"\t"<<root->wins<<"/"<<root->visits<<"\t"<<root->ucb<<root->children.size()<<std::endl;
 		for( auto& child : root->children ){
 			print_tree( child, depth+1 );
 		}
 	}
 
     virtual action take_action(const board& state) {
+		trace::span span("take_action", "game");
 		if( method == "mcts" )
 			return mcts_action(state);
 		else
@@ -260,63 +481,275 @@ class player : public random_agent {
 	}
 
     action mcts_action(const board& state) {
+		if( select == "ucb1tuned" )
+			return mcts_search<ucb1_tuned>(state);
+		else if( select == "puct" )
+			return mcts_search<puct>(state);
+		else if( select == "thompson" )
+			return mcts_search<thompson>(state);
+		else
+			return mcts_search<ucb1>(state);
+	}
+
+	template<typename selection>
+	action mcts_search(const board& state) {
+		if( nn )
+			return nn_search<selection>(state);
+		else if( rollout == "pattern" )
+			return mcts_search<selection, pattern_rollout>(state);
+		else
+			return mcts_search<selection, random_rollout>(state);
+	}
+
+	template<typename selection, typename rollout>
+	action mcts_search(const board& state) {
 		
 		const auto time_limit = std::chrono::milliseconds(t_limit);
 		const auto start_time = std::chrono::high_resolution_clock::now();
 		
-		Node* root = new Node( 3u-who, board::point(-1, -1) );
+		selection policy;
+		seed_policy(policy);
+		if (!std::isnan(c)) policy.c = c;
+		rollout play;
+		seed_policy(play);
+		typedef Node<selection> node;
+		node* root = new node( 3u-who, board::point(-1, -1) );
+		stats = search_stats();
+		auto batch_start = std::chrono::steady_clock::now(); // for tracing the simulations in batches of 64
 		for( int i = 0; i < T ; i++ ) {
 
 			board after = board(state);
 
-			// find the best node to expand
-			Node* expand_node = root->treePolicy( after );
+			// find the best node to expand, as the tree policy but timed by phases
+			auto t0 = std::chrono::steady_clock::now();
+			alloc_stats a0 = allocated();
+			node* expand_node = root->traverse( after, policy );
+			auto t1 = std::chrono::steady_clock::now();
+			alloc_stats a1 = allocated();
+			if( expand_node->expand( after ) ){
+				expand_node = expand_node->getBestChild( policy );
+				assert( after.place( expand_node->pos ) == board::legal );
+			}
+			auto t2 = std::chrono::steady_clock::now();
+			alloc_stats a2 = allocated();
 
-			// random run to add node and get reward
-			size_t winner = expand_node->defaultPolicy( after );
+			double score;
+			if( net ){
+				// short run and evaluate to get reward
+				score = expand_node->defaultPolicy( after, play, *net, depth );
+			}
+			else{
+				// random run to add node and get reward
+				size_t winner = expand_node->defaultPolicy( after, play );
+				score = winner == board::black ? 1 : 0;
+			}
+			auto t3 = std::chrono::steady_clock::now();
+			alloc_stats a3 = allocated();
 
 			// update all passing nodes with reward
-			expand_node->backPropagate( winner );
+			expand_node->backPropagateScore( score );
+			auto t4 = std::chrono::steady_clock::now();
+			alloc_stats a4 = allocated();
+
+			stats.allocs[0] += a1 - a0;
+			stats.allocs[1] += a2 - a1;
+			stats.allocs[2] += a3 - a2;
+			stats.allocs[3] += a4 - a3;
+			stats.selection += std::chrono::duration<double>(t1 - t0).count();
+			stats.expansion += std::chrono::duration<double>(t2 - t1).count();
+			stats.simulation += std::chrono::duration<double>(t3 - t2).count();
+			stats.backpropagation += std::chrono::duration<double>(t4 - t3).count();
+			stats.simulations++;
+			if( stats.simulations % 64 == 0 ){
+				trace::record("simulations", "search", batch_start, t4);
+				batch_start = t4;
+			}
 
 			if( i > 0.2*T && i%100 == 0 && std::chrono::high_resolution_clock::now() - start_time > time_limit ){
 				if( debug )
-					std::cout<<"time limit reached i = "<<i<<std::endl;
+					std::cerr<<"time limit reached i = "<<i<<std::endl;
 				break;
 			}
 
 		}
 
-		// get the best child
-		Node* best_child = nullptr;
+		if( stats.simulations % 64 ) trace::record("simulations", "search", batch_start, std::chrono::steady_clock::now());
+		stats.elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+		return best_action(root, state);
+    }
+
+	/**
+	 * search with the leaves evaluated by the neural network in batches
+	 * a batch is collected by descending the tree repeatedly with virtual losses
+	 */
+	template<typename selection>
+	action nn_search(const board& state) {
+
+		const auto time_limit = std::chrono::milliseconds(t_limit);
+		const auto start_time = std::chrono::high_resolution_clock::now();
+
+		selection policy;
+		seed_policy(policy);
+		if (!std::isnan(c)) policy.c = c;
+		typedef Node<selection> node;
+		node* root = new node( 3u-who, board::point(-1, -1) );
+		std::vector<node*> leaves;
+		std::vector<board> positions;
+		std::vector<mlp::result> results;
+		stats = search_stats();
+		auto batch_start = std::chrono::steady_clock::now(); // for tracing the batches
+		for( int i = 0; i < T ; ) {
+
+			// collect a batch of leaves, terminal leaves are resolved immediately
+			leaves.clear();
+			positions.clear();
+			for( int b = 0; b < batch && i < T; b++, i++ ) {
+				board after = board(state);
+				auto t0 = std::chrono::steady_clock::now();
+				alloc_stats a0 = allocated();
+				node* leaf = root->traverse( after, policy );
+				auto t1 = std::chrono::steady_clock::now();
+				alloc_stats a1 = allocated();
+				bool expanded = leaf->expandAll( after );
+				if( expanded ) leaf->addVirtualLoss();
+				auto t2 = std::chrono::steady_clock::now();
+				stats.allocs[0] += a1 - a0;
+				stats.allocs[1] += allocated() - a1;
+				stats.selection += std::chrono::duration<double>(t1 - t0).count();
+				stats.expansion += std::chrono::duration<double>(t2 - t1).count();
+				stats.simulations++;
+				if( !expanded ){
+					// the side to play has no legal move and loses
+					leaf->backPropagateScore( after.info().who_take_turns == board::black ? 0 : 1 );
+					continue;
+				}
+				leaves.push_back( leaf );
+				positions.push_back( after );
+			}
+
+			auto t3 = std::chrono::steady_clock::now();
+			alloc_stats a3 = allocated();
+			nn->evaluate( positions, results );
+			auto t4 = std::chrono::steady_clock::now();
+			alloc_stats a4 = allocated();
+			stats.allocs[2] += a4 - a3;
+			stats.simulation += std::chrono::duration<double>(t4 - t3).count();
+			trace::record("collect", "search", batch_start, t3);
+			trace::record("evaluate", "search", t3, t4);
+
+			for( size_t b = 0; b < leaves.size(); b++ ) {
+				node* leaf = leaves[b];
+				// priors by the softmax of the policy over the legal moves
+				float top = -std::numeric_limits<float>::max(), sum = 0;
+				for( auto& child : leaf->children ) top = std::max(top, results[b].policy[child->pos.i]);
+				for( auto& child : leaf->children ) sum += (child->prior = std::exp(results[b].policy[child->pos.i] - top));
+				for( auto& child : leaf->children ) child->prior /= sum;
+
+				leaf->revertVirtualLoss();
+				double p = results[b].value;
+				leaf->backPropagateScore( positions[b].info().who_take_turns == board::black ? p : 1 - p );
+			}
+			batch_start = std::chrono::steady_clock::now();
+			stats.allocs[3] += allocated() - a4;
+			stats.backpropagation += std::chrono::duration<double>(batch_start - t4).count();
+			trace::record("backpropagate", "search", t4, batch_start);
+
+			if( i > 0.2*T && std::chrono::high_resolution_clock::now() - start_time > time_limit ){
+				if( debug )
+					std::cerr<<"time limit reached i = "<<i<<std::endl;
+				break;
+			}
+		}
+
+		stats.elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+		return best_action(root, state);
+	}
+
+	/**
+	 * take the most visited child of the root as the move, and release the tree
+	 */
+	template<typename node>
+	action best_action(node* root, const board& state) {
+		// get the best child, and keep the visit distribution of the root and the statistics
+		stats.nodes = count_nodes(root, stats.depth);
+		node* best_child = nullptr;
+		visits.fill(0);
+		double sum = 0; // the root has one more visit than its children, i.e., the one that expanded it
+		for( auto& child : root->children ) sum += child->visits;
 		for( auto& child : root->children ){
 			if( best_child == nullptr || child->visits > best_child->visits ){
 				best_child = child;
 			}
+			visits[child->pos.i] = child->visits / std::max(sum, 1.0);
 		}
+		if( log ) std::cerr<<name()<<" "<<(best_child ? std::string(best_child->pos) : "resign")<<": "<<stats<<std::endl;
 
 		if( debug ){
-			std::cout<<"-----------------"<<std::endl;
-			std::cout<<state<<std::endl;
+			std::cerr<<"-----------------"<<std::endl;
+			std::cerr<<state<<std::endl;
 			print_tree(root, 0);
 		}
 
 		if( best_child == nullptr ){
-			if( debug ) std::cout<<"best child is null"<<std::endl;
-			delete root;
+			if( debug ) std::cerr<<"best child is null"<<std::endl;
+			teardown(root);
 			return action();
 		}
 
-		if( debug ) std::cout<<"best child : "<<best_child->pos<<std::endl;
+		if( debug ) std::cerr<<"best child : "<<best_child->pos<<std::endl;
 		action::place move =  action::place(best_child->pos.x, best_child->pos.y, who);
-		delete root;
+		teardown(root);
 		return move;
-    }
+	}
+
+	/**
+	 * the visit distribution over the points at the root of the last search
+	 */
+	const std::array<float, board::size_x * board::size_y>& root_visits() const { return visits; }
+
+	/**
+	 * the statistics of the last search
+	 */
+	const search_stats& last_search() const { return stats; }
+
+	template<typename node>
+	static void teardown(node* root) {
+		trace::span span("teardown");
+		delete root;
+	}
+
+	/**
+	 * the size of a tree, where depth is updated to the deepest level of the tree
+	 */
+	template<typename node>
+	static size_t count_nodes(const node* root, size_t& depth, size_t level = 0) {
+		size_t n = 1;
+		depth = std::max(depth, level);
+		for (const node* child : root->children) n += count_nodes(child, depth, level + 1);
+		return n;
+	}
+
+   private:
+	template<typename selection> void seed_policy(selection& policy) {}
+	void seed_policy(thompson& policy) { policy.engine.seed(engine()); }
+	void seed_policy(pattern_rollout& play) { play.engine.seed(engine()); }
+	void seed_policy(random_rollout& play) { play.engine.seed(engine()); }
 
    private:
     std::vector<action::place> space;
 	std::string method = "random";
+	std::string select = "ucb1";
+	double c = NAN; // the exploration constant, or the default of the selection policy
+	std::string rollout = "random";
+	std::shared_ptr<ntuple> net;
+	int depth = 0;
+	std::shared_ptr<mlp> nn;
+	int batch = 8;
     board::piece_type who;
 	int T = 12000, t_limit = 40000;
 	bool debug = false;
+	bool log = false;
+	std::array<float, board::size_x * board::size_y> visits = {};
+	search_stats stats;
 };
 
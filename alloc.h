@@ -0,0 +1,47 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * alloc.h: Count the allocations of each thread by hooking the global operator new
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/**
+ * the number of allocations and the bytes requested
+ */
+struct alloc_stats {
+	uint64_t count;
+	uint64_t bytes;
+
+	alloc_stats& operator +=(const alloc_stats& s) { count += s.count; bytes += s.bytes; return *this; }
+	alloc_stats operator -(const alloc_stats& s) const { return { count - s.count, bytes - s.bytes }; }
+};
+
+#ifdef ALLOC_STATS
+/**
+ * the accounting is enabled by compiling with -DALLOC_STATS (see "make alloc"), which replaces the
+ * global operator new and delete, thus this header should be included by only one translation unit
+ * the counts are thread-local, so that each search is charged with only its own allocations
+ */
+static thread_local alloc_stats allocations_of_thread = { 0, 0 };
+
+void* operator new(size_t size) {
+	allocations_of_thread.count++;
+	allocations_of_thread.bytes += size;
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+
+constexpr bool alloc_accounting = true;
+inline alloc_stats allocated() { return allocations_of_thread; }
+#else
+constexpr bool alloc_accounting = false;
+inline alloc_stats allocated() { return { 0, 0 }; }
+#endif
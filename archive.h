@@ -0,0 +1,227 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * archive.h: Compact binary archive of episodes with a random-access index
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "board.h"
+#include "action.h"
+#include "episode.h"
+
+/**
+ * the archive is laid out as follows (little-endian)
+ *   header:  "NGEA" | uint32 version
+ *   records: an episode per record, see below
+ *   index:   uint64 offset of each record
+ *   footer:  uint64 count | uint64 offset of the index | "NGEI"
+ * so that episode n is found in O(1) by reading the footer and the n-th entry of the index
+ *
+ * a record is
+ *   varint length | open tag | int64 open time | varint length | close tag | zigzag varint close time - open time
+ *   zigzag varint duration | varint moves | moves x uint8 code | moves x varint time
+ * where the code of a move is its point index, with the highest bit set for white (0xff for an unknown move),
+ * and the time of a move is the thinking time, which is already a delta from the start of the turn
+ *
+ * the open and close time are in milliseconds of the wall clock, while the duration and the thinking time
+ * are in microseconds, see episode.h (version 1 has no duration, and its thinking time is in milliseconds)
+ */
+class archive {
+public:
+	enum { version = 2 };
+
+	/**
+	 * check whether path is an archive, by its magic
+	 */
+	static bool probe(const std::string& path) {
+		char magic[4] = {};
+		std::ifstream(path, std::ios::in | std::ios::binary).read(magic, 4);
+		return std::string(magic, 4) == "NGEA";
+	}
+
+	/**
+	 * append episodes to a new archive, the index is written when closed
+	 */
+	class writer {
+	public:
+		writer(const std::string& path) : out(path, std::ios::out | std::ios::binary | std::ios::trunc), offset(0) {
+			if (!out.is_open()) throw std::invalid_argument("cannot open archive: " + path);
+			uint32_t ver = version;
+			put("NGEA", 4);
+			put(&ver, 4);
+		}
+		writer(const writer&) = delete;
+		writer& operator =(const writer&) = delete;
+		~writer() { close(); }
+
+		void write(const episode& ep) {
+			std::string rec;
+			encode(ep, rec);
+			index.push_back(offset);
+			put(rec.data(), rec.size());
+		}
+
+		void close() {
+			if (!out.is_open()) return;
+			uint64_t count = index.size(), at = offset;
+			put(index.data(), index.size() * sizeof(uint64_t));
+			put(&count, 8);
+			put(&at, 8);
+			put("NGEI", 4);
+			out.close();
+		}
+
+	private:
+		void put(const void* data, size_t size) {
+			out.write(static_cast<const char*>(data), size);
+			offset += size;
+		}
+
+		std::ofstream out;
+		uint64_t offset;
+		std::vector<uint64_t> index;
+	};
+
+	/**
+	 * read episodes from an archive in any order, the file is mapped read-only
+	 */
+	class reader {
+	public:
+		reader(const std::string& path) : base(nullptr), length(0), count(0), index(nullptr), ver(0) {
+			int fd = open(path.c_str(), O_RDONLY);
+			struct stat st;
+			if (fd == -1 || fstat(fd, &st) == -1) {
+				if (fd != -1) ::close(fd);
+				throw std::invalid_argument("cannot open archive: " + path);
+			}
+			length = st.st_size;
+			void* addr = length ? mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+			::close(fd);
+			if (addr == MAP_FAILED) throw std::invalid_argument("cannot map archive: " + path);
+			base = static_cast<const char*>(addr);
+
+			uint64_t at = 0;
+			bool valid = length >= 28 && std::memcmp(base, "NGEA", 4) == 0 && std::memcmp(base + length - 4, "NGEI", 4) == 0;
+			if (valid) std::memcpy(&ver, base + 4, 4);
+			valid = valid && ver >= 1 && ver <= version;
+			if (valid) {
+				std::memcpy(&count, base + length - 20, 8);
+				std::memcpy(&at, base + length - 12, 8);
+				valid = at >= 8 && at <= length - 20 && count == (length - 20 - at) / 8 && (length - 20 - at) % 8 == 0;
+			}
+			if (!valid) {
+				munmap(const_cast<char*>(base), length);
+				throw std::invalid_argument("invalid archive: " + path);
+			}
+			index = base + at;
+		}
+		reader(const reader&) = delete;
+		reader& operator =(const reader&) = delete;
+		~reader() { munmap(const_cast<char*>(base), length); }
+
+		size_t size() const { return count; }
+
+		/**
+		 * decode episode n, and throw if the record is corrupted
+		 */
+		void read(size_t n, episode& ep) const {
+			uint64_t at = 0, end = index - base;
+			if (n < count) std::memcpy(&at, index + n * 8, 8);
+			if (n + 1 < count) std::memcpy(&end, index + (n + 1) * 8, 8);
+			if (n >= count || at < 8 || at > end || end > size_t(index - base) || !decode(base + at, base + end, ep, ver))
+				throw std::out_of_range("invalid episode " + std::to_string(n) + " in archive");
+		}
+
+	private:
+		const char* base;
+		size_t length;
+		uint64_t count;
+		const char* index;
+		uint32_t ver;
+	};
+
+protected:
+	static void encode(const episode& ep, std::string& rec) {
+		put_string(rec, ep.ep_open.tag);
+		int64_t open = ep.ep_open.when;
+		rec.append(reinterpret_cast<const char*>(&open), 8);
+		put_string(rec, ep.ep_close.tag);
+		int64_t delta = int64_t(ep.ep_close.when) - open;
+		put_varint(rec, (uint64_t(delta) << 1) ^ uint64_t(delta >> 63));
+		int64_t elapsed = ep.ep_elapsed;
+		put_varint(rec, (uint64_t(elapsed) << 1) ^ uint64_t(elapsed >> 63));
+		put_varint(rec, ep.ep_moves.size());
+		for (const episode::move& mv : ep.ep_moves) {
+			action::place move(mv.code);
+			int i = move.position().i;
+			bool known = i >= 0 && i < board::size_x * board::size_y && (move.color() == board::black || move.color() == board::white);
+			rec.push_back(known ? char(i | (move.color() == board::white ? 0x80 : 0)) : char(0xff));
+		}
+		for (const episode::move& mv : ep.ep_moves) put_varint(rec, std::max<time_t>(mv.time, 0));
+	}
+
+	static bool decode(const char* p, const char* end, episode& ep, uint32_t ver = version) {
+		ep = {};
+		uint64_t delta = 0, elapsed = 0, moves = 0;
+		int64_t open = 0;
+		if (!get_string(p, end, ep.ep_open.tag) || end - p < 8) return false;
+		std::memcpy(&open, p, 8);
+		p += 8;
+		if (!get_string(p, end, ep.ep_close.tag) || !get_varint(p, end, delta)) return false;
+		if (ver >= 2 && !get_varint(p, end, elapsed)) return false;
+		if (!get_varint(p, end, moves)) return false;
+		ep.ep_open.when = open;
+		ep.ep_close.when = open + (int64_t(delta >> 1) ^ -int64_t(delta & 1));
+		ep.ep_elapsed = ver >= 2 ? (int64_t(elapsed >> 1) ^ -int64_t(elapsed & 1)) : (ep.ep_close.when - open) * 1000;
+		time_t scale = ver >= 2 ? 1 : 1000;
+		if (uint64_t(end - p) < moves) return false;
+		const uint8_t* codes = reinterpret_cast<const uint8_t*>(p);
+		p += moves;
+		for (size_t i = 0; i < moves; i++) {
+			uint64_t time = 0;
+			if (!get_varint(p, end, time)) return false;
+			action code = codes[i] == 0xff ? action() : action::place(codes[i] & 0x7f, codes[i] & 0x80 ? board::white : board::black);
+			ep.ep_moves.emplace_back(code, 0, time * scale);
+		}
+		return true;
+	}
+
+	static void put_varint(std::string& rec, uint64_t v) {
+		for (; v >= 0x80; v >>= 7) rec.push_back(char(v | 0x80));
+		rec.push_back(char(v));
+	}
+	static bool get_varint(const char*& p, const char* end, uint64_t& v) {
+		v = 0;
+		for (int shift = 0; p < end && shift < 64; shift += 7) {
+			uint8_t b = *p++;
+			v |= uint64_t(b & 0x7f) << shift;
+			if (!(b & 0x80)) return true;
+		}
+		return false;
+	}
+	static void put_string(std::string& rec, const std::string& s) {
+		put_varint(rec, s.size());
+		rec += s;
+	}
+	static bool get_string(const char*& p, const char* end, std::string& s) {
+		uint64_t size = 0;
+		if (!get_varint(p, end, size) || uint64_t(end - p) < size) return false;
+		s.assign(p, size);
+		p += size;
+		return true;
+	}
+};
@@ -0,0 +1,115 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * arena.h: Play local games concurrently on a pool of threads
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include "board.h"
+#include "action.h"
+#include "agent.h"
+#include "episode.h"
+
+/**
+ * the arena plays games on a pool of threads
+ *
+ * each thread keeps its own player instances, created from the arguments of the games,
+ * and reseeds them for every game by std::seed_seq of { base, game, color }, where the base is the seed=
+ * of the player if given, or the seed of the arena otherwise, and the games are counted across calls of play,
+ * so that every game is played with different, uncorrelated seeds, reproducible given the seeds
+ * finished episodes are reported in completion order, one at a time
+ */
+class arena {
+public:
+	/**
+	 * the arguments of black and white for game i
+	 */
+	typedef std::function<std::pair<std::string, std::string>(size_t)> pairing;
+	/**
+	 * called with each finished episode and its game index, in completion order
+	 * return false to stop starting new games, note that the games in progress are still reported
+	 */
+	typedef std::function<bool(const episode&, size_t)> observer;
+
+	arena(size_t jobs, unsigned seed = std::random_device()()) : jobs(std::max<size_t>(1, jobs)), seed(seed), played(0) {}
+
+	void play(size_t total, pairing pair, observer done) {
+		std::atomic<size_t> claimed(0);
+		std::atomic<bool> stopped(false);
+		std::mutex mutex;
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < jobs; t++) {
+			workers.emplace_back([&]() {
+				std::map<std::string, std::unique_ptr<player>> players;
+				auto instance = [&](const std::string& args, const std::string& role) -> player& {
+					std::unique_ptr<player>& who = players[role + ":" + args];
+					if (!who) who.reset(new player("name=" + role + " " + args + " role=" + role));
+					return *who;
+				};
+				for (size_t i; !stopped && (i = claimed++) < total; ) {
+					auto args = pair(i);
+					player& black = instance(args.first, "black");
+					player& white = instance(args.second, "white");
+					black.reseed(seed_of(args.first, played + i, board::black));
+					white.reseed(seed_of(args.second, played + i, board::white));
+					episode game;
+					run(game, black, white);
+					std::lock_guard<std::mutex> lock(mutex);
+					if (!done(game, i)) stopped = true;
+				}
+			});
+		}
+		for (std::thread& worker : workers) worker.join();
+		played += total;
+	}
+
+	/**
+	 * play a single game from the initial state
+	 */
+	static void run(episode& game, agent& black, agent& white) {
+		black.open_episode("~:" + white.name());
+		white.open_episode(black.name() + ":~");
+		game.open_episode(black.name() + ":" + white.name());
+		while (true) {
+			agent& who = game.take_turns(black, white);
+			action move = who.take_action(game.state());
+			if (game.apply_action(move) != true) break;
+			if (who.check_for_win(game.state())) break;
+		}
+		agent& win = game.last_turns(black, white);
+		game.close_episode(win.name());
+		black.close_episode(win.name());
+		white.close_episode(win.name());
+	}
+
+protected:
+	unsigned seed_of(const std::string& args, size_t game, unsigned color) const {
+		unsigned base = seed;
+		std::stringstream ss(args);
+		for (std::string pair; ss >> pair; ) {
+			if (pair.compare(0, 5, "seed=") == 0) base = std::stoul(pair.substr(5));
+		}
+		std::seed_seq seq{ base, unsigned(game), unsigned(game >> 32), color };
+		unsigned res;
+		seq.generate(&res, &res + 1);
+		return res;
+	}
+
+private:
+	size_t jobs;
+	unsigned seed;
+	size_t played;
+};
@@ -0,0 +1,240 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * bench.cpp: Benchmarks for the board primitives and the search of the player
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#define ALLOC_STATS // for reporting allocations per operation
+#include "alloc.h"
+#include "board.h"
+#include "action.h"
+#include "agent.h"
+#include "counters.h"
+
+/**
+ * the positions to be benchmarked, reached by playing random moves with a fixed seed
+ */
+std::vector<std::pair<std::string, board>> positions() {
+	std::vector<std::pair<std::string, board>> res;
+	player black("seed=1 role=black"), white("seed=2 role=white");
+	board state;
+	for (int ply = 0; ply <= 40; ply++) {
+		if (ply == 0)  res.emplace_back("early", state);
+		if (ply == 20) res.emplace_back("mid", state);
+		if (ply == 40) res.emplace_back("late", state);
+		player& who = (ply % 2) ? white : black;
+		if (who.take_action(state).apply(state) != board::legal) break;
+	}
+	return res;
+}
+
+/**
+ * the hardware counters for the microbenchmarks, or nullptr if not requested
+ */
+static counters* perf = nullptr;
+
+/**
+ * repeat an operation in rounds of 64 until the duration has elapsed
+ * the format is
+ * place    mid    120.5    8298755    0.00
+ * where the columns are the operation, the position, ns/op, ops/s, and allocations/op
+ * with the hardware counters, cycles/op, IPC, cache-misses/op, and branch-misses/op are appended
+ */
+template<typename operation>
+void measure(const std::string& name, const std::string& position, double duration, operation op) {
+	size_t ops = 0, allocs = allocated().count;
+	if (perf) perf->start();
+	auto start = std::chrono::steady_clock::now();
+	std::chrono::duration<double> elapsed(0);
+	for (size_t i = 0; elapsed.count() < duration; elapsed = std::chrono::steady_clock::now() - start) {
+		for (size_t r = 0; r < 64; r++) op(i++);
+		ops += 64;
+	}
+	counters::values hw = perf ? perf->stop() : counters::values();
+	allocs = allocated().count - allocs;
+	std::cout << name << "\t" << position << "\t" << std::fixed
+	          << std::setprecision(1) << (elapsed.count() * 1e9 / ops) << "\t"
+	          << std::setprecision(0) << (ops / elapsed.count()) << "\t"
+	          << std::setprecision(2) << (allocs * 1.0 / ops);
+	if (perf) {
+		std::cout << "\t" << std::setprecision(1) << (hw[counters::cycles] * 1.0 / ops)
+		          << "\t" << std::setprecision(2) << (hw[counters::instructions] * 1.0 / std::max<uint64_t>(hw[counters::cycles], 1))
+		          << "\t" << std::setprecision(3) << (hw[counters::cache_misses] * 1.0 / ops)
+		          << "\t" << std::setprecision(3) << (hw[counters::branch_misses] * 1.0 / ops);
+	}
+	std::cout << std::endl;
+}
+
+/**
+ * the speed of the board primitives, each measured for the given duration in seconds
+ * 'place' and 'action::apply' include copying the board, as both are done on a copy during the search
+ * 'check_liberty' is measured on every stone, thus is skipped for the empty board
+ * 'rollout' plays random moves until the end, and 'symmetry' is one of the 8 transforms
+ */
+void bench_board(double duration) {
+	std::cout << "op" << "\t" << "position" << "\t" << "ns/op" << "\t" << "ops/s" << "\t" << "allocs/op";
+	if (perf) std::cout << "\t" << "cycles/op" << "\t" << "IPC" << "\t" << "cache-misses/op" << "\t" << "branch-misses/op";
+	std::cout << std::endl;
+	volatile int sink = 0; // prevent the operations from being optimized away
+	for (auto& position : positions()) {
+		const std::string& where = position.first;
+		board state = position.second;
+		std::vector<board::point> legal = state.get_legal_pts(), stones;
+		const board::cell* cells = &state[0][0];
+		for (int i = 0; i < board::size_x * board::size_y; i++) {
+			if (cells[i] == board::black || cells[i] == board::white) stones.emplace_back(i);
+		}
+		std::vector<action> moves;
+		for (board::point p : legal) moves.push_back(action::place(p, state.info().who_take_turns));
+		std::default_random_engine engine(0);
+		random_rollout rollout;
+
+		measure("place", where, duration, [&](size_t i) {
+			board after = state;
+			sink = after.place(legal[i % legal.size()]);
+		});
+		if (stones.size()) measure("check_liberty", where, duration, [&](size_t i) {
+			board::point p = stones[i % stones.size()];
+			sink = state.check_liberty(p.x, p.y, state[p.x][p.y]);
+		});
+		measure("get_legal_pts", where, duration, [&](size_t i) {
+			sink = state.get_legal_pts().size();
+		});
+		measure("get_random_legal_pt", where, duration, [&](size_t i) {
+			sink = state.get_random_legal_pt(engine).i;
+		});
+		measure("rollout", where, duration, [&](size_t i) {
+			board after = state;
+			while (rollout.step(after));
+			sink = after.info().who_take_turns;
+		});
+		measure("symmetry", where, duration, [&](size_t i) {
+			board after = state;
+			after.rotate(i % 4);
+			if (i % 8 >= 4) after.reflect_horizontal();
+			sink = after(0);
+		});
+		measure("action::apply", where, duration, [&](size_t i) {
+			board after = state;
+			sink = moves[i % moves.size()].apply(after);
+		});
+	}
+}
+
+/**
+ * the throughput of each selection and rollout policy, in simulations per second
+ * where "ntuple" replaces the rollouts by the n-tuple network
+ * T is fixed and the time limit is lifted so that every search runs exactly T simulations
+ */
+void bench_policies(int T, int moves) {
+	const char* policies[] = { "ucb1", "ucb1tuned", "puct", "thompson" };
+	const char* rollouts[] = { "random", "pattern", "ntuple" };
+	std::cout << "policy" << "\t" << "rollout" << "\t" << "position" << "\t" << "sims/s" << std::endl;
+	for (auto& position : positions()) {
+		std::string role = position.second.info().who_take_turns == board::black ? "black" : "white";
+		for (const char* rollout : rollouts) {
+			for (const char* select : policies) {
+				player who("mcts seed=0 T=" + std::to_string(T) + " time=" + std::to_string(1 << 30) +
+				           " select=" + select + " role=" + role +
+				           (std::string(rollout) == "ntuple" ? " eval=ntuple depth=0" : std::string(" rollout=") + rollout));
+				auto start = std::chrono::steady_clock::now();
+				for (int i = 0; i < moves; i++) who.take_action(position.second);
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+				std::cout << select << "\t" << rollout << "\t" << position.first << "\t"
+				          << std::fixed << std::setprecision(0) << (T * moves / elapsed.count()) << std::endl;
+			}
+		}
+	}
+}
+
+/**
+ * the throughput of the neural network evaluator at batch sizes 1 ~ 64
+ * 'evals/s' is the raw evaluation speed, and 'sims/s' is the speed of the search using it
+ */
+void bench_nn(int T, int moves) {
+	auto suite = positions();
+	std::cout << "batch" << "\t" << "evals/s" << "\t" << "sims/s" << std::endl;
+	for (int batch = 1; batch <= 64; batch *= 2) {
+		mlp nn;
+		std::vector<board> boards;
+		std::vector<mlp::result> results;
+		for (int i = 0; i < batch; i++) boards.push_back(suite[i % suite.size()].second);
+		int rounds = std::max(1, 20000 / batch);
+		auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++) nn.evaluate(boards, results);
+		std::chrono::duration<double> evals = std::chrono::steady_clock::now() - start;
+
+		player who("mcts seed=0 eval=nn select=puct batch=" + std::to_string(batch) + " T=" + std::to_string(T) +
+		           " time=" + std::to_string(1 << 30) + " role=black");
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < moves; i++) who.take_action(suite[0].second);
+		std::chrono::duration<double> sims = std::chrono::steady_clock::now() - start;
+
+		std::cout << batch << "\t" << std::fixed << std::setprecision(0)
+		          << (rounds * batch / evals.count()) << "\t" << (T * moves / sims.count()) << std::endl;
+	}
+}
+
+int main(int argc, const char* argv[]) {
+	std::cout << "HollowNoGo-Bench: ";
+	std::copy(argv, argv + argc, std::ostream_iterator<const char*>(std::cout, " "));
+	std::cout << std::endl << std::endl;
+
+	int T = 2000, moves = 3;
+	double duration = 0.2;
+	std::string run = "board,policies,nn";
+	bool hardware = false;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		auto match_arg = [&](std::string flag) -> bool {
+			auto it = arg.find_first_not_of('-');
+			return arg.find(flag, it) == it;
+		};
+		auto next_opt = [&]() -> std::string {
+			auto it = arg.find('=') + 1;
+			return it ? arg.substr(it) : argv[++i];
+		};
+		if (match_arg("T")) {
+			T = std::stoi(next_opt());
+		} else if (match_arg("moves")) {
+			moves = std::stoi(next_opt());
+		} else if (match_arg("duration")) {
+			duration = std::stod(next_opt());
+		} else if (match_arg("run")) {
+			run = next_opt();
+		} else if (match_arg("perf")) {
+			hardware = true;
+		}
+	}
+
+	counters hw;
+	if (hardware && hw.available()) {
+		perf = &hw;
+	} else if (hardware) {
+		std::cerr << "hardware counters are not available, check kernel.perf_event_paranoid" << std::endl;
+	}
+
+	auto selected = [&](const std::string& name) { return ("," + run + ",").find("," + name + ",") != std::string::npos; };
+	if (selected("board")) {
+		bench_board(duration);
+		std::cout << std::endl;
+	}
+	if (selected("policies")) {
+		bench_policies(T, moves);
+		std::cout << std::endl;
+	}
+	if (selected("nn")) {
+		bench_nn(T, moves);
+	}
+	return 0;
+}
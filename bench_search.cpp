@@ -0,0 +1,147 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * bench_search.cpp: End-to-end benchmark of the search on a fixed suite of positions, reported in JSON
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <sys/resource.h>
+#include "board.h"
+#include "action.h"
+#include "agent.h"
+
+/**
+ * load the suite, where each line is a name followed by the moves from the initial state
+ * empty lines and lines starting with '#' are ignored
+ */
+std::vector<std::pair<std::string, board>> load_suite(const std::string& path) {
+	std::ifstream in(path);
+	if (!in.is_open()) throw std::invalid_argument("cannot open suite: " + path);
+	std::vector<std::pair<std::string, board>> suite;
+	for (std::string line; std::getline(in, line); ) {
+		std::stringstream ss(line);
+		std::string name;
+		if (!(ss >> name) || name[0] == '#') continue;
+		board state;
+		for (std::string move; ss >> move; ) {
+			if (state.place(board::point(move)) != board::legal)
+				throw std::invalid_argument("illegal move " + move + " in position " + name);
+		}
+		suite.emplace_back(name, state);
+	}
+	return suite;
+}
+
+/**
+ * the peak resident set size of the whole process in KiB, which never goes down
+ */
+long peak_rss() {
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+std::string quote(const std::string& text) {
+	std::string res = "\"";
+	for (char c : text) {
+		if (c == '"' || c == '\\') res += '\\';
+		res += c;
+	}
+	return res + "\"";
+}
+
+/**
+ * search each position once by a fresh player with the given seed, and write the results as
+ * { "args": ..., "seed": ..., "positions": [ { "name", "move", "simulations", "nodes", "depth", "elapsed",
+ *   "sims_per_sec", "phases": { "selection", "expansion", "simulation", "backpropagation" },
+ *   "tree_kb" }, ... ], "total": { "simulations", "elapsed", "sims_per_sec", "process_peak_rss_kb" } }
+ * where the times are in seconds, tree_kb is the size of the nodes in the search tree of the position,
+ * and process_peak_rss_kb is the peak of the whole process, sampled once after all positions
+ */
+void bench_search(const std::vector<std::pair<std::string, board>>& suite, const std::string& args,
+                  unsigned seed, std::ostream& out) {
+	size_t simulations = 0;
+	double elapsed = 0;
+	const size_t node_size = sizeof(Node<ucb1>) + sizeof(Node<ucb1>*); // a node and its entry in the children of its parent
+	out << "{" << std::endl;
+	out << "\t\"args\": " << quote(args) << "," << std::endl;
+	out << "\t\"seed\": " << seed << "," << std::endl;
+	out << "\t\"positions\": [" << std::endl;
+	for (size_t i = 0; i < suite.size(); i++) {
+		const board& state = suite[i].second;
+		std::string role = state.info().who_take_turns == board::black ? "black" : "white";
+		// the time limit is lifted first so that the search is reproducible, unless it is given in args
+		player who("time=" + std::to_string(1 << 30) + " " + args + " seed=" + std::to_string(seed) + " role=" + role);
+		action::place move = who.take_action(state);
+		const search_stats& stats = who.last_search();
+		simulations += stats.simulations;
+		elapsed += stats.elapsed;
+
+		out << "\t\t{ ";
+		out << "\"name\": " << quote(suite[i].first) << ", ";
+		out << "\"move\": " << quote(move.position()) << ", ";
+		out << "\"simulations\": " << stats.simulations << ", ";
+		out << "\"nodes\": " << stats.nodes << ", ";
+		out << "\"depth\": " << stats.depth << ", ";
+		out << "\"elapsed\": " << stats.elapsed << ", ";
+		out << "\"sims_per_sec\": " << (stats.simulations / stats.elapsed) << ", ";
+		out << "\"phases\": { ";
+		out << "\"selection\": " << stats.selection << ", ";
+		out << "\"expansion\": " << stats.expansion << ", ";
+		out << "\"simulation\": " << stats.simulation << ", ";
+		out << "\"backpropagation\": " << stats.backpropagation << " }, ";
+		out << "\"tree_kb\": " << (stats.nodes * node_size / 1024) << " }";
+		out << (i + 1 < suite.size() ? "," : "") << std::endl;
+	}
+	out << "\t]," << std::endl;
+	out << "\t\"total\": { ";
+	out << "\"simulations\": " << simulations << ", ";
+	out << "\"elapsed\": " << elapsed << ", ";
+	out << "\"sims_per_sec\": " << (simulations / elapsed) << ", ";
+	out << "\"process_peak_rss_kb\": " << peak_rss() << " }" << std::endl;
+	out << "}" << std::endl;
+}
+
+int main(int argc, const char* argv[]) {
+	std::string suite_path = "search-suite.txt", output_path;
+	std::string args = "mcts T=2000 rollout=pattern";
+	unsigned seed = 0;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		auto match_arg = [&](std::string flag) -> bool {
+			auto it = arg.find_first_not_of('-');
+			return arg.find(flag, it) == it;
+		};
+		auto next_opt = [&]() -> std::string {
+			auto it = arg.find('=') + 1;
+			return it ? arg.substr(it) : argv[++i];
+		};
+		if (match_arg("suite")) {
+			suite_path = next_opt();
+		} else if (match_arg("args")) {
+			args = next_opt();
+		} else if (match_arg("seed")) {
+			seed = std::stoul(next_opt());
+		} else if (match_arg("output")) {
+			output_path = next_opt();
+		}
+	}
+
+	auto suite = load_suite(suite_path);
+	if (output_path.size()) {
+		std::ofstream out(output_path, std::ios::out | std::ios::trunc);
+		bench_search(suite, args, seed, out);
+	} else {
+		bench_search(suite, args, seed, std::cout);
+	}
+	return 0;
+}
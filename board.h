@@ -123,6 +123,21 @@ public:
 		std::vector<int> indices;
 		for( int i = 0 ; i < size_x * size_y ; i++ ) indices.emplace_back(i);
 		std::random_shuffle(indices.begin(), indices.end());
+		return get_first_legal_pt( indices, who );
+	}
+
+	/**
+	 * same as above, but shuffled by the given random engine instead of the global one
+	 */
+	template<typename engine>
+	const point get_random_legal_pt( engine& g, size_t who = -1 ){
+		std::vector<int> indices;
+		for( int i = 0 ; i < size_x * size_y ; i++ ) indices.emplace_back(i);
+		std::shuffle(indices.begin(), indices.end(), g);
+		return get_first_legal_pt( indices, who );
+	}
+
+	const point get_first_legal_pt( const std::vector<int>& indices, size_t who = -1 ){
 		// find the first legal move
 		for( int i = 0 ; i < size_x * size_y ; i++ ){
 			board after(*this);
@@ -0,0 +1,76 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * convert.cpp: Convert episodes between the text format and the binary archive
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include "episode.h"
+#include "archive.h"
+
+/**
+ * usage: ./convert <input> <output>, or ./convert --episode=<n> <archive>
+ * the direction is decided by the input, i.e., an archive is converted to text, and text to an archive
+ * the text is converted line by line, so that the whole file is never held in memory
+ */
+int main(int argc, const char* argv[]) {
+	std::vector<std::string> paths;
+	long long show = -1;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		auto match_arg = [&](std::string flag) -> bool {
+			auto it = arg.find_first_not_of('-');
+			return arg.find(flag, it) == it;
+		};
+		auto next_opt = [&]() -> std::string {
+			auto it = arg.find('=') + 1;
+			return it ? arg.substr(it) : argv[++i];
+		};
+		if (arg[0] == '-' && match_arg("episode")) {
+			show = std::stoll(next_opt());
+		} else {
+			paths.push_back(arg);
+		}
+	}
+
+	if (show >= 0 && paths.size() == 1) { // print an episode of an archive
+		archive::reader in(paths[0]);
+		episode ep;
+		in.read(show, ep);
+		std::cout << ep << std::endl;
+		return 0;
+	}
+	if (paths.size() != 2) {
+		std::cerr << "usage: " << argv[0] << " <input> <output>, or " << argv[0] << " --episode=<n> <archive>" << std::endl;
+		return 1;
+	}
+
+	size_t count = 0;
+	if (archive::probe(paths[0])) { // archive to text
+		archive::reader in(paths[0]);
+		std::ofstream out(paths[1], std::ios::out | std::ios::trunc);
+		episode ep;
+		for (; count < in.size(); count++) {
+			in.read(count, ep);
+			out << ep << std::endl;
+		}
+	} else { // text to archive
+		std::ifstream in(paths[0], std::ios::in);
+		if (!in.is_open()) throw std::invalid_argument("cannot open " + paths[0]);
+		archive::writer out(paths[1]);
+		episode ep;
+		for (std::string line; std::getline(in, line) && line.size(); count++) {
+			std::stringstream(line) >> ep;
+			out.write(ep);
+		}
+	}
+	std::cout << count << " episodes converted" << std::endl;
+	return 0;
+}
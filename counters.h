@@ -0,0 +1,88 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * counters.h: Read hardware performance counters of the calling thread by perf_event_open
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <array>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/**
+ * cycles, instructions, cache misses, and branch misses of the calling thread, counted in user space
+ * the counters are opened as a group so that they are scheduled together
+ *
+ * opening may fail, e.g., in a container or with kernel.perf_event_paranoid > 2,
+ * in which case available() is false and the counts are all zero
+ */
+class counters {
+public:
+	enum { cycles, instructions, cache_misses, branch_misses, size };
+	typedef std::array<uint64_t, size> values;
+
+	counters() {
+		fds.fill(-1);
+		const uint64_t configs[size] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+		for (int i = 0; i < size; i++) {
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.size = sizeof(attr);
+			attr.config = configs[i];
+			attr.disabled = i == 0; // the group is enabled through its leader
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP;
+			fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0);
+			if (fds[i] < 0) {
+				close_all();
+				return;
+			}
+		}
+	}
+	counters(const counters&) = delete;
+	counters& operator =(const counters&) = delete;
+	~counters() { close_all(); }
+
+	bool available() const { return fds[0] >= 0; }
+
+	void start() {
+		if (!available()) return;
+		ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	/**
+	 * stop counting, and return the counts since start
+	 */
+	values stop() {
+		values res = {};
+		if (!available()) return res;
+		ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+		uint64_t buf[1 + size] = {}; // the number of counters, followed by the counts
+		if (read(fds[0], buf, sizeof(buf)) == ssize_t(sizeof(buf))) {
+			for (int i = 0; i < size; i++) res[i] = buf[1 + i];
+		}
+		return res;
+	}
+
+private:
+	void close_all() {
+		for (int& fd : fds) {
+			if (fd >= 0) close(fd);
+			fd = -1;
+		}
+	}
+
+	std::array<int, size> fds;
+};
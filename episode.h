@@ -19,9 +19,14 @@
 #include "action.h"
 #include "agent.h"
 
+/**
+ * the thinking time of moves and the duration of the episode are measured by a monotonic clock in microseconds,
+ * while the wall clock is kept only for the date, i.e., the open and close time in milliseconds
+ */
 class episode {
+	friend class archive; // for the binary format, see archive.h
 public:
-	episode() : ep_state(initial_state()), ep_score(0), ep_time(0) {
+	episode() : ep_state(initial_state()), ep_score(0), ep_time(0), ep_begin(0), ep_elapsed(0) {
 		ep_moves.reserve(board::size_x * board::size_y);
 	}
 
@@ -32,19 +37,22 @@ public:
 
 	void open_episode(const std::string& tag) {
 		ep_open = { tag, millisec() };
+		ep_begin = microsec();
+		ep_elapsed = -1; // ongoing
 	}
 	void close_episode(const std::string& tag) {
-		ep_close = { tag, millisec() };
+		ep_elapsed = microsec() - ep_begin;
+		ep_close = { tag, ep_open.when + ep_elapsed / 1000 };
 	}
 	bool apply_action(action move) {
 		board::reward reward = move.apply(state());
 		if (reward != board::legal) return false;
-		ep_moves.emplace_back(move, reward, millisec() - ep_time);
+		ep_moves.emplace_back(move, reward, microsec() - ep_time);
 		ep_score += reward;
 		return true;
 	}
 	agent& take_turns(agent& black, agent& white) {
-		ep_time = millisec();
+		ep_time = microsec();
 		return (step() % 2) ? white : black;
 	}
 	agent& last_turns(agent& black, agent& white) {
@@ -77,7 +85,7 @@ public:
 			break;
 		case action::place::type:
 		default:
-			time = ep_close.when - ep_open.when;
+			time = ep_elapsed;
 			break;
 		}
 		return time;
@@ -102,8 +110,37 @@ public:
 		return res;
 	}
 
+	std::vector<time_t> times(unsigned who = -1u) const {
+		std::vector<time_t> res;
+		switch (who) {
+		case board::black:
+		case action::black::type:
+			for (size_t i = 0; i < ep_moves.size(); i += 2) res.push_back(ep_moves[i].time);
+			break;
+		case board::white:
+		case action::white::type:
+			for (size_t i = 1; i < ep_moves.size(); i += 2) res.push_back(ep_moves[i].time);
+			break;
+		case action::place::type:
+		default:
+			for (const move& mv : ep_moves) res.push_back(mv.time);
+			break;
+		}
+		return res;
+	}
+
 public:
 
+	/**
+	 * an episode is saved as an SGF line, e.g.,
+	 * (;FF[4]...C[TCG|black:white@1792155562637|black@1792155562814|us=177031,1250,830,...];B[da]C[1];W[dg]...)
+	 * where the open and close time are in milliseconds of the wall clock, and 'us=' lists the duration
+	 * and the thinking time of each move in microseconds
+	 *
+	 * the thinking time is also kept as C[ms] of each move (omitted if below 1 ms), which duplicates 'us='
+	 * on purpose: the readers before 'us=' skip it and read only C[ms], so that their times stay nonzero
+	 * for slow moves; the readers since then prefer 'us=', and fall back to C[ms] for the older files
+	 */
 	friend std::ostream& operator <<(std::ostream& out, const episode& ep) {
 		out << '(';
 		out << ";FF[4]CA[UTF-8]AP[TCG-NoGo-Demo]";
@@ -117,7 +154,10 @@ public:
 		out << "DT[" << std::put_time(std::localtime(&date), "%Y-%m-%d") << "]";
 		std::string winner = ep.ep_close.tag;
 		out << "RE[" << (names.find(winner) == 0 ? "B" : "W") << "+R]";
-		out << "C[TCG|" << ep.ep_open << "|" << ep.ep_close << "]";
+		out << "C[TCG|" << ep.ep_open << "|" << ep.ep_close;
+		out << "|us=" << ep.ep_elapsed;
+		for (const move& mv : ep.ep_moves) out << "," << mv.time;
+		out << "]";
 		for (const move& mv : ep.ep_moves) out << mv;
 		out << ')';
 		return out;
@@ -133,12 +173,21 @@ public:
 			ss >> ep.ep_open;
 			ss.ignore(1); // |
 			ss >> ep.ep_close;
-			ss.ignore(1); // ]
+			std::vector<time_t> times; // in microseconds, or in milliseconds by the moves if not given
+			ep.ep_elapsed = (ep.ep_close.when - ep.ep_open.when) * 1000;
+			if (ss.peek() == '|' && ss.ignore(1) && ss.peek() == 'u') {
+				ss.ignore(3); // us=
+				ss >> std::dec >> ep.ep_elapsed;
+				for (time_t t; ss.peek() == ',' && ss.ignore(1) && ss >> t; times.push_back(t));
+			}
 			while (ss.peek() != ';' && ss.ignore(1));
 			while (ss.peek() == ';') {
 				ep.ep_moves.emplace_back();
 				ss >> ep.ep_moves.back();
 			}
+			if (times.size() == ep.ep_moves.size()) {
+				for (size_t i = 0; i < times.size(); i++) ep.ep_moves[i].time = times[i];
+			}
 			ep.ep_score = 0;
 		} else {
 			in.setstate(std::ios::failbit);
@@ -157,16 +206,17 @@ protected:
 		operator action() const { return code; }
 		friend std::ostream& operator <<(std::ostream& out, const move& m) {
 			out << m.code;
-			if (m.time) out << "C[" << std::dec << m.time << "]";
+			if (m.time >= 1000) out << "C[" << std::dec << (m.time / 1000) << "]"; // in milliseconds, see above
 			return out;
 		}
 		friend std::istream& operator >>(std::istream& in, move& m) {
 			in >> m.code;
 			m.reward = 0;
 			m.time = 0;
-			if (in.peek() == 'C') {
+			if (in.peek() == 'C') { // the time in milliseconds, replaced by 'us=' if given
 				in.ignore(2); // C[
 				in >> std::dec >> m.time;
+				m.time *= 1000;
 				in.ignore(1); // ]
 			}
 			return in;
@@ -193,12 +243,18 @@ protected:
 		auto now = std::chrono::system_clock::now().time_since_epoch();
 		return std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
 	}
+	static time_t microsec() {
+		auto now = std::chrono::steady_clock::now().time_since_epoch();
+		return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+	}
 
 private:
 	board ep_state;
 	board::score ep_score;
 	std::vector<move> ep_moves;
-	time_t ep_time;
+	time_t ep_time; // the start of the current turn
+	time_t ep_begin; // the start of the episode
+	time_t ep_elapsed; // the duration of the episode, or negative if ongoing
 
 	meta ep_open;
 	meta ep_close;
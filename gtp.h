@@ -0,0 +1,116 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * gtp.h: Communicate with a GTP program running as a child process
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <chrono>
+#include <csignal>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/**
+ * a GTP program launched by /bin/sh, whose stdin and stdout are connected by pipes
+ * the stderr of the program is inherited
+ */
+class gtp_engine {
+public:
+	enum status { success, failure, timeout };
+
+	gtp_engine(const std::string& command) : pid(-1), in(-1), out(-1) {
+		signal(SIGPIPE, SIG_IGN); // a terminated program should not terminate the caller
+		int to_child[2], from_child[2];
+		if (pipe2(to_child, O_CLOEXEC) != 0) return;
+		if (pipe2(from_child, O_CLOEXEC) != 0) {
+			close(to_child[0]);
+			close(to_child[1]);
+			return;
+		}
+		pid = fork();
+		if (pid == 0) { // the child, where only async-signal-safe calls are allowed before exec
+			setpgid(0, 0);
+			dup2(to_child[0], STDIN_FILENO);
+			dup2(from_child[1], STDOUT_FILENO);
+			execl("/bin/sh", "sh", "-c", command.c_str(), (char*) nullptr);
+			_exit(127);
+		}
+		close(to_child[0]);
+		close(from_child[1]);
+		in = to_child[1];
+		out = from_child[0];
+	}
+	gtp_engine(const gtp_engine&) = delete;
+	gtp_engine& operator =(const gtp_engine&) = delete;
+
+	/**
+	 * ask the program to quit, and kill its process group if it does not exit in a second
+	 */
+	~gtp_engine() {
+		if (in != -1 && write(in, "quit\n", 5)) {}
+		if (in != -1) close(in);
+		if (out != -1) close(out);
+		if (pid <= 0) return;
+		for (int i = 0; i < 200 && waitpid(pid, nullptr, WNOHANG) == 0; i++) usleep(5000);
+		if (kill(-pid, SIGKILL) == 0) waitpid(pid, nullptr, 0);
+	}
+
+	/**
+	 * send a command and wait for its response within the timeout in milliseconds (negative for no limit)
+	 * lines before the response that start with neither '=' nor '?' are ignored, e.g., banners
+	 * the reply is the response without the leading "= " and the trailing blank line
+	 */
+	status send(const std::string& command, std::string& reply, long timeout_ms = -1) {
+		reply.clear();
+		std::string line = command + "\n";
+		if (in == -1 || write(in, line.data(), line.size()) != ssize_t(line.size())) return failure;
+
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+		std::string response;
+		bool started = false;
+		while (true) {
+			// consume the complete lines in the buffer
+			for (size_t eol; (eol = buffer.find('\n')) != std::string::npos; ) {
+				line = buffer.substr(0, eol);
+				buffer.erase(0, eol + 1);
+				if (line.size() && line.back() == '\r') line.pop_back();
+				if (!started && (line.empty() || (line[0] != '=' && line[0] != '?'))) continue;
+				if (started && line.empty()) {
+					bool ok = response[0] == '=';
+					size_t begin = response.find_first_not_of(' ', 1);
+					reply = begin != std::string::npos ? response.substr(begin) : "";
+					return ok ? success : failure;
+				}
+				response += (started ? "\n" : "") + line;
+				started = true;
+			}
+
+			int wait = -1;
+			if (timeout_ms >= 0) {
+				auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+				if (left.count() <= 0) return timeout;
+				wait = left.count();
+			}
+			pollfd fd = { out, POLLIN, 0 };
+			int ready = poll(&fd, 1, wait);
+			if (ready == 0) return timeout;
+			if (ready < 0) continue;
+			char chunk[4096];
+			ssize_t n = read(out, chunk, sizeof(chunk));
+			if (n <= 0) return failure; // the program exited
+			buffer.append(chunk, n);
+		}
+	}
+
+private:
+	pid_t pid;
+	int in, out;
+	std::string buffer;
+};
@@ -0,0 +1,85 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * histogram.h: Log-linear histogram of latencies for percentiles
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+/**
+ * an HDR-style histogram, where each power of two [2^e, 2^(e+1)) is split into 2^precision buckets,
+ * so that a recorded value is kept within a relative error of 2^-precision, i.e., 3.1% by default,
+ * with a fixed cost per record regardless of the range of values
+ *
+ * values below 2^precision are counted exactly
+ */
+class histogram {
+public:
+	enum { precision = 5, sub = 1 << precision };
+
+	histogram() : total(0), largest(0) {}
+
+	void record(uint64_t v) {
+		size_t i = index(v);
+		if (i >= counts.size()) counts.resize(i + 1, 0);
+		counts[i]++;
+		total++;
+		largest = std::max(largest, v);
+	}
+
+	uint64_t count() const { return total; }
+	uint64_t max() const { return largest; }
+
+	/**
+	 * the value at the given percentile, e.g., 99 for p99, reported as the highest value of its bucket
+	 */
+	uint64_t percentile(double p) const {
+		if (!total) return 0;
+		uint64_t rank = std::max<uint64_t>(1, uint64_t(p / 100 * total + 0.5));
+		uint64_t seen = 0;
+		for (size_t i = 0; i < counts.size(); i++) {
+			seen += counts[i];
+			if (seen >= rank) return std::min(highest(i), largest);
+		}
+		return largest;
+	}
+
+	histogram& operator +=(const histogram& h) {
+		if (h.counts.size() > counts.size()) counts.resize(h.counts.size(), 0);
+		for (size_t i = 0; i < h.counts.size(); i++) counts[i] += h.counts[i];
+		total += h.total;
+		largest = std::max(largest, h.largest);
+		return *this;
+	}
+
+	void clear() {
+		counts.clear();
+		total = 0;
+		largest = 0;
+	}
+
+protected:
+	static size_t index(uint64_t v) {
+		if (v < sub) return v;
+		int e = 63 - __builtin_clzll(v); // v is in [2^e, 2^(e+1))
+		int shift = e - precision;
+		return sub + size_t(e - precision) * sub + ((v >> shift) - sub);
+	}
+	static uint64_t highest(size_t i) {
+		if (i < sub) return i;
+		int shift = (i - sub) / sub;
+		uint64_t lowest = uint64_t(sub + (i - sub) % sub) << shift;
+		return lowest + (uint64_t(1) << shift) - 1;
+	}
+
+private:
+	std::vector<uint64_t> counts;
+	uint64_t total;
+	uint64_t largest;
+};
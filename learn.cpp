@@ -0,0 +1,176 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * learn.cpp: Learn the weights of 3x3 patterns from saved episodes
+ *
+ * the weights are fitted by the minorization-maximization (MM) algorithm for Bradley-Terry models,
+ * where every played move is a competition won by its pattern against the patterns of all legal moves
+ * patterns are merged under the 8 symmetries and normalized to black to play
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cmath>
+#include "board.h"
+#include "action.h"
+#include "pattern.h"
+#include "episode.h"
+
+/**
+ * the competitions extracted by a worker
+ * the candidates of competition j are patterns[offset[j]] ~ patterns[offset[j + 1] - 1],
+ * where the first candidate is the winner, i.e., the pattern of the played move
+ */
+struct competitions {
+	std::vector<pattern::code> patterns;
+	std::vector<size_t> offset = { 0 };
+	size_t episodes = 0;
+
+	size_t size() const { return offset.size() - 1; }
+
+	/**
+	 * replay an episode and collect a competition for each move
+	 */
+	void extract(const episode& ep) {
+		board state;
+		for (const action& move : ep.actions()) {
+			unsigned who = state.info().who_take_turns;
+			board::point played = action::place(move).position();
+			auto code_of = [&](const board::point& p) -> pattern::code {
+				pattern::code c = pattern::at(state, p.x, p.y);
+				return pattern::canonical(who == board::white ? pattern::swap(c) : c);
+			};
+			std::vector<board::point> legal = state.get_legal_pts();
+			if (move.apply(state) != board::legal) break;
+			patterns.push_back(code_of(played));
+			for (const board::point& p : legal) {
+				if (p.i != played.i) patterns.push_back(code_of(p));
+			}
+			offset.push_back(patterns.size());
+		}
+		episodes++;
+	}
+
+	/**
+	 * extract the episodes of the lines that start within [begin, end) of the file
+	 */
+	void extract(const std::string& path, std::streamoff begin, std::streamoff end) {
+		std::ifstream in(path, std::ios::in);
+		in.seekg(begin ? begin - 1 : 0);
+		std::string line;
+		if (begin) std::getline(in, line); // the line is owned by the previous chunk
+		while (in.tellg() < end && std::getline(in, line)) {
+			episode ep;
+			if (line.size() && std::stringstream(line) >> ep) extract(ep);
+		}
+	}
+};
+
+int main(int argc, const char* argv[]) {
+	std::cout << "HollowNoGo-Learn: ";
+	std::copy(argv, argv + argc, std::ostream_iterator<const char*>(std::cout, " "));
+	std::cout << std::endl << std::endl;
+
+	std::vector<std::string> load_paths;
+	std::string save_path = "patterns.bin", export_path;
+	size_t iterations = 20, threads = std::max(1u, std::thread::hardware_concurrency());
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		auto match_arg = [&](std::string flag) -> bool {
+			auto it = arg.find_first_not_of('-');
+			return arg.find(flag, it) == it;
+		};
+		auto next_opt = [&]() -> std::string {
+			auto it = arg.find('=') + 1;
+			return it ? arg.substr(it) : argv[++i];
+		};
+		if (match_arg("load")) {
+			load_paths.push_back(next_opt());
+		} else if (match_arg("save")) {
+			save_path = next_opt();
+		} else if (match_arg("export")) {
+			export_path = next_opt();
+		} else if (match_arg("iterations")) {
+			iterations = std::stoull(next_opt());
+		} else if (match_arg("threads")) {
+			threads = std::max<size_t>(1, std::stoull(next_opt()));
+		}
+	}
+
+	// extract the competitions in parallel, each worker takes a chunk of every file
+	std::vector<competitions> works(threads);
+	for (const std::string& path : load_paths) {
+		std::ifstream in(path, std::ios::in | std::ios::ate);
+		std::streamoff size = in.tellg();
+		if (size <= 0) {
+			std::cerr << "cannot load episodes: " << path << std::endl;
+			continue;
+		}
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < threads; t++) {
+			std::streamoff begin = size * t / threads, end = size * (t + 1) / threads;
+			workers.emplace_back([&, t, begin, end]() { works[t].extract(path, begin, end); });
+		}
+		for (std::thread& worker : workers) worker.join();
+	}
+
+	size_t episodes = 0, total = 0;
+	std::vector<double> wins(pattern::count, 0);
+	for (const competitions& work : works) {
+		episodes += work.episodes;
+		total += work.size();
+		for (size_t j = 0; j < work.size(); j++) wins[work.patterns[work.offset[j]]]++;
+	}
+	std::cout << "episodes = " << episodes << ", competitions = " << total << std::endl;
+	if (total == 0) return 1;
+
+	// MM iterations, gamma = wins / (sum of 1 / strength of the competitions involved)
+	// plus a virtual win and a virtual loss against a pattern of gamma 1 to regularize rare patterns
+	std::vector<double> gamma(pattern::count, 1.0);
+	for (size_t n = 1; n <= iterations; n++) {
+		std::vector<std::vector<double>> denoms(threads, std::vector<double>(pattern::count, 0));
+		std::vector<double> loglik(threads, 0);
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < threads; t++) {
+			workers.emplace_back([&, t]() {
+				const competitions& work = works[t];
+				std::vector<double>& denom = denoms[t];
+				for (size_t j = 0; j < work.size(); j++) {
+					double strength = 0;
+					for (size_t k = work.offset[j]; k < work.offset[j + 1]; k++) strength += gamma[work.patterns[k]];
+					for (size_t k = work.offset[j]; k < work.offset[j + 1]; k++) denom[work.patterns[k]] += 1 / strength;
+					loglik[t] += std::log(gamma[work.patterns[work.offset[j]]] / strength);
+				}
+			});
+		}
+		for (std::thread& worker : workers) worker.join();
+
+		double ll = 0;
+		for (double l : loglik) ll += l;
+		for (size_t c = 0; c < pattern::count; c++) {
+			if (pattern::canonical(c) != c) continue;
+			double denom = 2 / (gamma[c] + 1);
+			for (const std::vector<double>& d : denoms) denom += d[c];
+			gamma[c] = (wins[c] + 1) / denom;
+		}
+		std::cout << "iteration " << n << ": log-likelihood = " << (ll / total) << std::endl;
+	}
+
+	pattern::table weights;
+	for (size_t c = 0; c < pattern::count; c++) weights[c] = gamma[pattern::canonical(c)];
+	pattern::save(save_path, weights);
+	std::cout << "weights saved to " << save_path << std::endl;
+	if (export_path.size()) {
+		pattern::save_quantized(export_path, weights);
+		std::cout << "quantized weights saved to " << export_path << std::endl;
+	}
+	return 0;
+}
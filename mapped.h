@@ -0,0 +1,111 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * mapped.h: Map a text file read-only and split it into chunks of lines for parsing in parallel
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+class mapped_file {
+public:
+	typedef std::pair<const char*, const char*> chunk;
+
+	/**
+	 * map the file at path, where the text ends at its first empty line as read by std::getline,
+	 * so that anything appended after an empty line, e.g., the latency of a save file, is left to tail
+	 */
+	mapped_file(const std::string& path) : base(nullptr), length(0), text(0) {
+		int fd = ::open(path.c_str(), O_RDONLY);
+		struct stat st;
+		if (fd == -1 || fstat(fd, &st) == -1) {
+			if (fd != -1) ::close(fd);
+			throw std::invalid_argument("cannot open " + path);
+		}
+		length = st.st_size;
+		void* addr = length ? mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+		::close(fd);
+		if (addr == MAP_FAILED) throw std::invalid_argument("cannot map " + path);
+		base = static_cast<const char*>(addr);
+		if (length) madvise(addr, length, MADV_SEQUENTIAL);
+		for (text = 0; text < length && base[text] != '\n' && base[text] != '\r'; ) { // find the first empty line
+			const char* eol = static_cast<const char*>(std::memchr(base + text, '\n', length - text));
+			text = eol ? eol - base + 1 : length;
+		}
+	}
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator =(const mapped_file&) = delete;
+	~mapped_file() { if (length) munmap(const_cast<char*>(base), length); }
+
+	/**
+	 * the length of the text, i.e., up to its first empty line
+	 */
+	size_t size() const { return text; }
+
+	/**
+	 * the rest of the file after the text, i.e., from its first empty line
+	 */
+	chunk tail() const { return chunk(base + text, base + length); }
+
+	/**
+	 * split the text into at most n chunks of about the same size, each of which ends at the end of a line
+	 */
+	std::vector<chunk> split(size_t n) const {
+		std::vector<chunk> res;
+		n = std::max<size_t>(n, 1);
+		const char* end = base + text;
+		for (const char* begin = base; begin < end; ) {
+			const char* cut = begin + std::max<size_t>(1, (end - begin) / (n - res.size()));
+			if (res.size() + 1 == n || cut >= end) cut = end;
+			if (cut < end && cut[-1] != '\n') {
+				const char* eol = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+				cut = eol ? eol + 1 : end;
+			}
+			res.emplace_back(begin, cut);
+			begin = cut;
+		}
+		return res;
+	}
+
+	/**
+	 * invoke line(begin, end) for each non-empty line in a chunk, where end excludes the line break
+	 */
+	template<typename F>
+	static void for_each_line(const chunk& c, F line) {
+		for (const char* begin = c.first; begin < c.second; ) {
+			const char* eol = static_cast<const char*>(std::memchr(begin, '\n', c.second - begin));
+			const char* end = eol ? eol : c.second;
+			if (end > begin && end[-1] == '\r') end--;
+			if (end > begin) line(begin, end);
+			begin = eol ? eol + 1 : c.second;
+		}
+	}
+
+	/**
+	 * invoke task(i) for i in [0, n) with a thread each, where the last one runs on the calling thread
+	 */
+	template<typename F>
+	static void parallel(size_t n, F task) {
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i + 1 < n; i++) workers.emplace_back(task, i);
+		if (n) task(n - 1);
+		for (std::thread& worker : workers) worker.join();
+	}
+
+private:
+	const char* base;
+	size_t length;
+	size_t text;
+};
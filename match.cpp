@@ -0,0 +1,189 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * match.cpp: Play matches between two GTP programs, with games running concurrently
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include "board.h"
+#include "action.h"
+#include "agent.h"
+#include "episode.h"
+#include "statistics.h"
+#include "gtp.h"
+#include "sprt.h"
+
+/**
+ * the commands of both programs, as in run-gogui-twogtp.sh
+ * P1 plays black in even games and white in odd games
+ */
+struct programs {
+	std::string p1b, p1w, p2b, p2w;
+};
+
+/**
+ * how a game ended, from the view of the loser
+ */
+enum class ending { normal, resign, illegal, timeout };
+
+/**
+ * play a game between two GTP programs, where each side has time_limit milliseconds in total
+ * the loser is the side to play when the game ends, i.e., who has no legal move, resigns,
+ * plays an illegal move, rejects the legal move of its opponent, or runs out of time
+ */
+ending play(episode& game, const std::string& black_cmd, const std::string& white_cmd,
+            agent& black, agent& white, long time_limit) {
+	gtp_engine black_engine(black_cmd), white_engine(white_cmd);
+	gtp_engine* engines[] = { &black_engine, &white_engine };
+	for (gtp_engine* engine : engines) {
+		std::string reply;
+		engine->send("boardsize " + std::to_string(board::size_x), reply);
+		engine->send("clear_board", reply);
+	}
+
+	long remain[] = { time_limit, time_limit };
+	ending end = ending::normal;
+	game.open_episode(black.name() + ":" + white.name());
+	while (true) {
+		game.take_turns(black, white);
+		int side = game.state().info().who_take_turns == board::black ? 0 : 1;
+		const char* color = side == 0 ? "b" : "w";
+		if (board(game.state()).get_legal_pts().empty()) break;
+
+		std::string reply;
+		auto start = std::chrono::steady_clock::now();
+		gtp_engine::status status = engines[side]->send(std::string("genmove ") + color, reply, remain[side]);
+		remain[side] -= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		if (status == gtp_engine::timeout || remain[side] < 0) {
+			end = ending::timeout;
+			break;
+		}
+		if (status != gtp_engine::success || reply == "resign") {
+			end = ending::resign;
+			break;
+		}
+		action::place move(board::point(reply), side == 0 ? board::black : board::white);
+		if (game.apply_action(move) != true) {
+			end = ending::illegal;
+			break;
+		}
+		std::string ack;
+		if (engines[1 - side]->send(std::string("play ") + color + " " + reply, ack) != gtp_engine::success) {
+			end = ending::illegal; // the opponent, who is now to play, disagrees on the board
+			break;
+		}
+	}
+	agent& win = game.last_turns(black, white);
+	game.close_episode(win.name());
+	return end;
+}
+
+int main(int argc, const char* argv[]) {
+	std::cout << "HollowNoGo-Match: ";
+	std::copy(argv, argv + argc, std::ostream_iterator<const char*>(std::cout, " "));
+	std::cout << std::endl << std::endl;
+
+	size_t total = 10, block = 0, limit = 0, jobs = std::max(1u, std::thread::hardware_concurrency());
+	long time_limit = 40; // total thinking time of each side in seconds
+	programs cmds;
+	std::string save_path;
+	std::string sprt_args;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		auto match_arg = [&](std::string flag) -> bool {
+			auto it = arg.find_first_not_of('-');
+			return arg.find(flag, it) == it;
+		};
+		auto next_opt = [&]() -> std::string {
+			auto it = arg.find('=') + 1;
+			return it ? arg.substr(it) : argv[++i];
+		};
+		if (match_arg("total")) {
+			total = std::stoull(next_opt());
+		} else if (match_arg("block")) {
+			block = std::stoull(next_opt());
+		} else if (match_arg("limit")) {
+			limit = std::stoull(next_opt());
+		} else if (match_arg("jobs")) {
+			jobs = std::max<size_t>(1, std::stoull(next_opt()));
+		} else if (match_arg("time")) {
+			time_limit = std::stol(next_opt());
+		} else if (match_arg("p1b")) {
+			cmds.p1b = next_opt();
+		} else if (match_arg("p1w")) {
+			cmds.p1w = next_opt();
+		} else if (match_arg("p2b")) {
+			cmds.p2b = next_opt();
+		} else if (match_arg("p2w")) {
+			cmds.p2w = next_opt();
+		} else if (match_arg("save")) {
+			save_path = next_opt();
+		} else if (match_arg("sprt")) {
+			sprt_args = next_opt();
+		}
+	}
+	if (cmds.p1b.empty() || cmds.p1w.empty() || cmds.p2b.empty() || cmds.p2w.empty()) {
+		std::cerr << "commands of P1B, P1W, P2B, and P2W are required" << std::endl;
+		return 1;
+	}
+
+	statistics stats(total, block, limit);
+	sprt test(sprt_args); // P1 is engine A and P2 is engine B, used only if sprt_args is specified
+	size_t wins[] = { 0, 0 }, timeouts[] = { 0, 0 }, illegals[] = { 0, 0 };
+	std::mutex mutex;
+	std::atomic<size_t> claimed(0);
+	std::atomic<bool> stopped(false);
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < jobs; t++) {
+		workers.emplace_back([&]() {
+			agent p1("name=P1"), p2("name=P2");
+			for (size_t i; !stopped && (i = claimed++) < total; ) {
+				bool p1_black = i % 2 == 0;
+				episode game;
+				ending end = p1_black ? play(game, cmds.p1b, cmds.p2w, p1, p2, time_limit * 1000)
+				                      : play(game, cmds.p2b, cmds.p1w, p2, p1, time_limit * 1000);
+				// the winner is the last side to move, and the loser is the other
+				bool black_wins = game.step() % 2 == 1;
+				int winner = (black_wins == p1_black) ? 0 : 1;
+				std::lock_guard<std::mutex> lock(mutex);
+				wins[winner]++;
+				if (end == ending::timeout) timeouts[1 - winner]++;
+				if (end == ending::illegal) illegals[1 - winner]++;
+				stats.add_episode(game);
+				if (sprt_args.empty() || test.status() != sprt::undecided) continue;
+				test.add(winner == 0);
+				if (block && test.games() % block == 0) std::cout << test << std::endl;
+				if (test.status() != sprt::undecided) stopped = true;
+			}
+		});
+	}
+	for (std::thread& worker : workers) worker.join();
+
+	size_t played = wins[0] + wins[1];
+	const char* label[] = { "P1", "P2" };
+	for (int p = 0; p < 2; p++) {
+		std::cout << label[p] << ": " << wins[p] << "/" << played << " = " << (wins[p] * 100.0 / played) << "%";
+		if (timeouts[p]) std::cout << ", TLE = " << timeouts[p];
+		if (illegals[p]) std::cout << ", IA = " << illegals[p];
+		std::cout << std::endl;
+	}
+	if (sprt_args.size()) std::cout << test << std::endl;
+
+	if (save_path.size()) {
+		std::ofstream out(save_path, std::ios::out | std::ios::trunc);
+		out << stats;
+		out.close();
+	}
+	return 0;
+}
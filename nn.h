@@ -0,0 +1,146 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * nn.h: Define the small neural network for evaluating board states in batches
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <vector>
+#include <array>
+#include <string>
+#include <random>
+#include <cmath>
+#include <stdexcept>
+#include "board.h"
+#include "qweight.h"
+
+/**
+ * multilayer perceptron with a policy head and a value head
+ *
+ *   input:  81 cells x { own, opponent, empty }, relative to the side to play (hollow cells are all zero)
+ *   hidden: 64 -> ReLU -> 64 -> ReLU
+ *   policy: 81 logits, one for each point
+ *   value:  the chance that the side to play wins
+ *
+ * positions are evaluated in batches, so that each row of weights is loaded once for the whole batch
+ * the kernels are written with GCC vector extensions, which are compiled into SIMD instructions
+ */
+class mlp {
+public:
+	enum {
+		cells = board::size_x * board::size_y,
+		inputs = cells * 3,
+		hidden = 64,
+		outputs = (cells + 7) / 8 * 8, // policy logits, padded to the vector width
+	};
+
+	struct result {
+		std::array<float, cells> policy; // logits
+		float value;
+	};
+
+	/**
+	 * initialize with random weights (He initialization)
+	 */
+	mlp(unsigned seed = 0) : w1(inputs * hidden), b1(hidden), w2(hidden * hidden), b2(hidden),
+		wp(hidden * outputs), bp(outputs), wv(hidden), bv(1) {
+		std::default_random_engine engine(seed);
+		std::normal_distribution<float> input(0, std::sqrt(2.0f / inputs)), layer(0, std::sqrt(2.0f / hidden));
+		for (float& w : w1) w = input(engine);
+		for (float& w : w2) w = layer(engine);
+		for (size_t i = 0; i < wp.size(); i++) wp[i] = (i % outputs < cells) ? layer(engine) * 0.1f : 0;
+		for (float& w : wv) w = layer(engine) * 0.1f;
+	}
+
+	/**
+	 * evaluate a batch of positions
+	 */
+	void evaluate(const std::vector<board>& batch, std::vector<result>& res) const {
+		size_t n = batch.size();
+		res.resize(n);
+		std::vector<float>& x = buffer(0, n * inputs), & h1 = buffer(1, n * hidden), & h2 = buffer(2, n * hidden);
+		std::vector<float>& p = buffer(3, n * outputs);
+		for (size_t b = 0; b < n; b++) encode(batch[b], &x[b * inputs]);
+		gemm<hidden>(x.data(), n, inputs, w1.data(), b1.data(), h1.data(), true);
+		gemm<hidden>(h1.data(), n, hidden, w2.data(), b2.data(), h2.data(), true);
+		gemm<outputs>(h2.data(), n, hidden, wp.data(), bp.data(), p.data(), false);
+		for (size_t b = 0; b < n; b++) {
+			std::copy(&p[b * outputs], &p[b * outputs] + cells, res[b].policy.begin());
+			float v = bv[0];
+			for (size_t k = 0; k < hidden; k++) v += h2[b * hidden + k] * wv[k];
+			res[b].value = 1.0f / (1.0f + std::exp(-v));
+		}
+	}
+
+public:
+	/**
+	 * the weights are stored as a quantized weight file of kind "MLP1",
+	 * with tables w1, b1, w2, b2, wp, bp, wv, bv, where each w is laid out as [input][output]
+	 */
+	void load(const std::string& path) {
+		qweight file(path);
+		std::vector<std::vector<float>*> tables = layers();
+		bool valid = file.kind() == "MLP1" && file.size() == tables.size();
+		for (size_t i = 0; valid && i < tables.size(); i++) valid = file[i].size == tables[i]->size();
+		if (!valid) throw std::invalid_argument("invalid network weights: " + path);
+		for (size_t i = 0; i < tables.size(); i++)
+			for (size_t k = 0; k < tables[i]->size(); k++) (*tables[i])[k] = file[i][k];
+	}
+	void save_quantized(const std::string& path) const {
+		std::vector<std::vector<float>> tables;
+		for (std::vector<float>* t : const_cast<mlp*>(this)->layers()) tables.push_back(*t);
+		qweight::save(path, "MLP1", tables);
+	}
+
+protected:
+	typedef float v8 __attribute__((vector_size(32), aligned(4)));
+
+	/**
+	 * out[n][cols] = act(in[n][rows] * w[rows][cols] + bias[cols]), where cols is a multiple of 8
+	 * the loop over rows is outermost so that a row of w is held in registers for the whole batch,
+	 * and zero inputs are skipped since the board encoding is sparse
+	 */
+	template<size_t cols>
+	static void gemm(const float* in, size_t n, size_t rows, const float* w, const float* bias, float* out, bool relu) {
+		for (size_t b = 0; b < n; b++) std::copy(bias, bias + cols, out + b * cols);
+		for (size_t r = 0; r < rows; r++) {
+			v8 wr[cols / 8];
+			for (size_t c = 0; c < cols / 8; c++) wr[c] = reinterpret_cast<const v8*>(w + r * cols)[c];
+			for (size_t b = 0; b < n; b++) {
+				float a = in[b * rows + r];
+				if (a == 0) continue;
+				v8 av = { a, a, a, a, a, a, a, a };
+				v8* o = reinterpret_cast<v8*>(out + b * cols);
+				for (size_t c = 0; c < cols / 8; c++) o[c] += av * wr[c];
+			}
+		}
+		if (relu) {
+			for (size_t i = 0; i < n * cols; i++) out[i] = std::max(out[i], 0.0f);
+		}
+	}
+
+	static void encode(const board& b, float* x) {
+		const board::cell* cells = &b[0][0];
+		unsigned own = b.info().who_take_turns;
+		for (int i = 0; i < mlp::cells; i++) {
+			unsigned c = cells[i];
+			x[i * 3 + 0] = c == own;
+			x[i * 3 + 1] = c == 3u - own;
+			x[i * 3 + 2] = c == board::empty;
+		}
+	}
+
+	std::vector<float>& buffer(size_t i, size_t size) const {
+		static thread_local std::array<std::vector<float>, 4> buffers;
+		buffers[i].resize(size);
+		return buffers[i];
+	}
+
+	std::vector<std::vector<float>*> layers() { return { &w1, &b1, &w2, &b2, &wp, &bp, &wv, &bv }; }
+
+private:
+	std::vector<float> w1, b1, w2, b2, wp, bp, wv, bv;
+};
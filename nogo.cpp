@@ -11,20 +11,47 @@
 #include <fstream>
 #include <iterator>
 #include <string>
+#include <cstdlib>
+#include <climits>
 #include "board.h"
 #include "action.h"
 #include "agent.h"
+#include "pattern.h"
 #include "episode.h"
 #include "statistics.h"
+#include "ntuple.h"
+#include "trainer.h"
+#include "selfplay.h"
+#include "arena.h"
+#include "sprt.h"
+#include "tuner.h"
+#include "perft.h"
+#include "trace.h"
 
 int main(int argc, const char* argv[]) {
 	std::cout << "HollowNoGo-Demo: ";
 	std::copy(argv, argv + argc, std::ostream_iterator<const char*>(std::cout, " "));
 	std::cout << std::endl << std::endl;
 
-	size_t total = 1000, block = 0, limit = 0;
+	size_t total = 1000, block = 0, limit = 0, jobs = 1;
 	std::string black_args, white_args;
 	std::string load_path, save_path;
+	bool summary = false; // summarize load_path without keeping the episodes
+	bool stream = false; // append each episode to save_path as it closes
+	size_t fsync_every = 0;
+	std::string pattern_path;
+	std::string weights_path, export_path; // for training
+	size_t threads = std::max(1u, std::thread::hardware_concurrency());
+	float alpha = 0.1, epsilon = 0.1;
+	bool train = false;
+	std::string selfplay_dir; // for generating training data
+	bool augment = false;
+	unsigned seed = std::random_device()(); // the base seed of self-play and arena games
+	std::string sprt_args; // for regression tests
+	std::string tune_params; // for tuning player arguments
+	float tune_rate = 0.05;
+	int perft_depth = 0; // for counting the game tree
+	size_t perft_cache = 0;
 	std::string name = "TCG-HollowNoGo-Demo", version = "2022"; // for GTP shell
 	bool shell = false;
 	for (int i = 1; i < argc; i++) {
@@ -43,36 +70,161 @@ int main(int argc, const char* argv[]) {
 			block = std::stoull(next_opt());
 		} else if (match_arg("limit")) {
 			limit = std::stoull(next_opt());
+		} else if (match_arg("jobs")) {
+			jobs = std::max<size_t>(1, std::stoull(next_opt()));
 		} else if (match_arg("black")) {
 			black_args = next_opt();
 		} else if (match_arg("white")) {
 			white_args = next_opt();
 		} else if (match_arg("load")) {
 			load_path = next_opt();
+		} else if (match_arg("summary")) {
+			summary = true;
 		} else if (match_arg("save")) {
 			save_path = next_opt();
+		} else if (match_arg("stream")) {
+			stream = true;
+		} else if (match_arg("fsync")) {
+			fsync_every = std::stoull(next_opt());
+		} else if (match_arg("pattern")) {
+			pattern_path = next_opt();
 		} else if (match_arg("name")) {
 			name = next_opt();
 		} else if (match_arg("version")) {
 			version = next_opt();
 		} else if (match_arg("shell")) {
 			shell = true;
+		} else if (match_arg("train")) {
+			train = true;
+		} else if (match_arg("weights")) {
+			weights_path = next_opt();
+		} else if (match_arg("export")) {
+			export_path = next_opt();
+		} else if (match_arg("threads")) {
+			threads = std::max<size_t>(1, std::stoull(next_opt()));
+		} else if (match_arg("alpha")) {
+			alpha = std::stof(next_opt());
+		} else if (match_arg("epsilon")) {
+			epsilon = std::stof(next_opt());
+		} else if (match_arg("selfplay-data")) {
+			selfplay_dir = next_opt();
+		} else if (match_arg("augment")) {
+			augment = true;
+		} else if (match_arg("seed")) {
+			seed = std::stoul(next_opt());
+		} else if (match_arg("sprt")) {
+			sprt_args = next_opt();
+		} else if (match_arg("perft-cache")) {
+			perft_cache = std::stoull(next_opt());
+		} else if (match_arg("perft")) {
+			perft_depth = std::stoi(next_opt());
+		} else if (match_arg("trace")) {
+			trace::open(next_opt());
+		} else if (match_arg("tune-rate")) {
+			tune_rate = std::stof(next_opt());
+		} else if (match_arg("tune")) {
+			tune_params = next_opt();
 		}
 	}
 
+	if (stream && !limit) { // keep the memory flat, since the episodes are already on disk
+		limit = std::max<size_t>(1, block);
+	}
+
+	if (pattern_path.size()) {
+		pattern::load(pattern_path);
+	}
+
+	if (train) { // train the n-tuple network by self-play, with a checkpoint every block games
+		ntuple net;
+		if (weights_path.size() && qweight::probe(weights_path)) { // mapped read-only, see ntuple.h
+			std::cerr << "cannot train quantized weights: " << weights_path << ", use the float weights instead" << std::endl;
+			return 1;
+		}
+		if (weights_path.size() && std::ifstream(weights_path).good()) net.load(weights_path);
+		td_trainer trainer(net, alpha, epsilon);
+		trainer.train(total, threads, weights_path, block);
+		if (export_path.size()) net.save_quantized(export_path);
+		return 0;
+	}
+
+	if (selfplay_dir.size()) { // generate training data by self-play, with a report every block games
+		selfplay generator(black_args, white_args, augment, seed);
+		generator.generate(selfplay_dir, total, threads, block);
+		return 0;
+	}
+
+	if (perft_depth > 0 && !shell) { // count the game tree from the initial state to each depth
+		perft counter(perft_cache, threads);
+		for (int depth = 1; depth <= perft_depth; depth++) {
+			perft::result res = counter.run(board(), depth);
+			std::cout << "perft " << depth << "\t" << "leaves = " << res.leaves << ", " << "nodes = " << res.nodes << ", "
+			          << "nodes/s = " << (res.nodes / res.elapsed) << std::endl;
+		}
+		return 0;
+	}
+
+	if (tune_params.size()) { // tune the arguments of black by SPSA, with total iterations of block games
+		spsa tuner(black_args, tune_params, tune_rate, seed);
+		tuner.tune(total, block ? block : 16, jobs);
+		std::cout << tuner.args() << std::endl;
+		return 0;
+	}
+
+	if (summary && load_path.size()) { // summarize the episodes by the given threads, then exit
+		if (archive::probe(load_path)) statistics::summarize(archive::reader(load_path), threads);
+		else                           statistics::summarize(mapped_file(load_path), threads);
+		return 0;
+	}
+
 	statistics stats(total, block, limit);
 
-	if (load_path.size()) {
-		std::ifstream in(load_path, std::ios::in);
-		in >> stats;
-		in.close();
+	size_t loaded_text = 0; // the length of the episodes in load_path, if it is text
+	if (load_path.size() && archive::probe(load_path)) {
+		stats.load(archive::reader(load_path), threads);
 		if (stats.is_finished()) stats.summary();
+	} else if (load_path.size() && std::ifstream(load_path).good()) { // a missing file starts from nothing
+		mapped_file in(load_path);
+		stats.load(in, threads);
+		loaded_text = in.size();
+		if (stats.is_finished()) stats.summary();
+	}
+
+	std::unique_ptr<episode_writer> writer;
+	if (stream && save_path.size()) { // the loaded episodes are kept in the output, as if saved at exit
+		bool append = save_path == load_path && !archive::probe(load_path); // never append text to an archive
+		if (append && loaded_text && truncate(save_path.c_str(), loaded_text) != 0) { // the latency after the episodes is rewritten when closed
+			throw std::runtime_error("cannot truncate " + save_path);
+		}
+		writer.reset(new episode_writer(save_path, append, fsync_every));
+		for (size_t i = 0; !append && i < stats.size(); i++) writer->write(stats.at(i));
+		stats.stream(writer.get());
 	}
 
 	player black("name=black " + black_args + " role=black");
 	player white("name=white " + white_args + " role=white");
 
-	if (!shell) { // launch standard local games
+	if (!shell && sprt_args.size()) { // test engine A (black) against engine B (white) with colors alternated
+		sprt test(sprt_args);
+		arena pool(jobs, seed);
+		std::string engine_a = "name=A " + black_args, engine_b = "name=B " + white_args; // so that the episodes tell the engines apart
+		pool.play(total, [&](size_t i) {
+			return i % 2 == 0 ? std::make_pair(engine_a, engine_b) : std::make_pair(engine_b, engine_a);
+		}, [&](const episode& game, size_t i) {
+			stats.add_episode(game);
+			if (test.status() != sprt::undecided) return false; // the game was in progress when decided
+			bool black_wins = game.step() % 2 == 1;
+			test.add(black_wins == (i % 2 == 0));
+			if (block && test.games() % block == 0) std::cout << test << std::endl;
+			return test.status() == sprt::undecided;
+		});
+		std::cout << test << std::endl;
+	} else if (!shell && jobs > 1) { // launch local games concurrently
+		size_t remain = total - std::min(total, stats.step());
+		arena pool(jobs, seed);
+		pool.play(remain, [&](size_t) { return std::make_pair(black_args, white_args); },
+		          [&](const episode& game, size_t) { stats.add_episode(game); return true; });
+	} else if (!shell) { // launch standard local games
 		while (!stats.is_finished()) {
 //			std::cerr << "======== Game " << stats.step() << " ========" << std::endl;
 			black.open_episode("~:" + white.name());
@@ -94,15 +246,18 @@ int main(int argc, const char* argv[]) {
 			white.close_episode(win.name());
 		}
 	} else { // launch GTP shell
+		player* searcher = &black; // the player who generated the last move
 		for (std::string command; std::getline(std::cin, command); ) {
 			if (command.back() == '\r') command.pop_back();
 			if (command.empty()) continue;
+			trace::span span(command, "gtp");
 
 			std::vector<std::string> args;
 			std::istringstream iss(command);
 			for (std::string s; getline(iss, s, ' '); args.push_back(s));
 
 			std::string reply;
+			char status = '='; // '?' for a failure
 			if (args[0] == "play" || args[0] == "genmove") { // play a move, or generate a move and play
 				if (!stats.is_episode_ongoing()) { // should open an episode
 					black.open_episode("~:" + white.name());
@@ -144,6 +299,7 @@ int main(int argc, const char* argv[]) {
 						break;
 					}
 				} else if (args[0] == "genmove") { // generate a move and play
+					searcher = &who == &white ? &white : &black;
 					action::place move = who.take_action(game.state());
 					if (game.apply_action(move) == true) {
 						reply = move.position();
@@ -174,6 +330,26 @@ int main(int argc, const char* argv[]) {
 				}
 				if (size > board::size_x || size > board::size_y) break;
 
+			} else if (args[0] == "perft") { // count the game tree from the current state
+				char* end = nullptr;
+				long depth = args.size() > 1 ? std::strtol(args[1].c_str(), &end, 10) : -1;
+				if (args.size() < 2 || end == args[1].c_str() || *end || depth < 0 || depth > INT_MAX) {
+					status = '?';
+					reply = "invalid depth";
+				} else {
+					perft counter(perft_cache, threads);
+					perft::result res = counter.run(stats.is_episode_ongoing() ? stats.back().state() : board(), int(depth));
+					reply = std::to_string(res.leaves) + " (nodes = " + std::to_string(res.nodes) + ", "
+					        + "nodes/s = " + std::to_string(uint64_t(res.nodes / res.elapsed)) + ")";
+				}
+
+			} else if (args[0] == "engine_stats") { // report the statistics of the last search
+				player* who = searcher; // the given color is only for this query
+				if (args.size() > 1) who = std::tolower(args[1][0]) == 'w' ? &white : &black;
+				std::stringstream buf;
+				buf << who->last_search();
+				reply = buf.str();
+
 			} else if (args[0] == "name") { // report the name of the program
 				reply = name;
 			} else if (args[0] == "version") { // report the version number of the program
@@ -182,20 +358,22 @@ int main(int argc, const char* argv[]) {
 				reply = "2";
 			} else if (args[0] == "list_commands") { // print supported commands
 				reply = "play\n" "genmove\n" "clear_board\n" "showboard\n" "boardsize\n"
-				        "name\n" "version\n" "protocol_version\n" "list_commands\n" "quit\n";
+				        "perft\n" "engine_stats\n" "name\n" "version\n" "protocol_version\n" "list_commands\n" "quit\n";
 			} else {
 				reply = "unknown command";
 			}
 
-			std::cout << "= " << reply << std::endl << std::endl;
+			std::cout << status << " " << reply << std::endl << std::endl;
 		}
 	}
 
-	if (save_path.size()) {
+	if (save_path.size() && !writer) {
 		std::ofstream out(save_path, std::ios::out | std::ios::trunc);
 		out << stats;
 		out.close();
 	}
 
+	if (writer && !writer->close()) return 1; // the error is reported by the writer
+
 	return 0;
 }
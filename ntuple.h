@@ -0,0 +1,160 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * ntuple.h: Define the n-tuple network for evaluating board states
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <memory>
+#include <assert.h>
+#include "board.h"
+#include "weight.h"
+#include "qweight.h"
+
+/**
+ * n-tuple network over the 9x9 hollow board
+ *
+ * each tuple is a set of cells, whose states index a lookup table
+ * the cells are read relative to the side to play, i.e., empty (0), own (1), opponent (2), or hollow (3)
+ * every tuple is looked up under all 8 symmetries of the board, sharing the same table
+ *
+ * the sum of the lookups is the logit of the chance that the side to play wins
+ *
+ * the tables are either owned in float, or read from a mapped quantized weight file,
+ * where the latter is read-only and cannot be trained
+ */
+class ntuple {
+public:
+	enum { symmetries = 8 };
+
+	/**
+	 * the default tuples are 3x2 rectangles, which cover the whole board under the symmetries
+	 */
+	ntuple() {
+		const int anchors[][2] = { {0, 0}, {0, 1}, {0, 2}, {0, 3}, {1, 0}, {1, 1}, {1, 2}, {2, 2}, {3, 3} };
+		for (auto& anchor : anchors) {
+			std::vector<int> cells;
+			for (int dx = 0; dx < 3; dx++)
+				for (int dy = 0; dy < 2; dy++)
+					cells.push_back(board::point(anchor[0] + dx, anchor[1] + dy).i);
+			add_tuple(cells);
+		}
+	}
+
+	/**
+	 * add a tuple of the cells given in 1-d array style, along with its table
+	 * the isomorphic cells are derived by transforming a board whose cells hold their own indices
+	 */
+	void add_tuple(const std::vector<int>& cells) {
+		board index;
+		for (int i = 0; i < board::size_x * board::size_y; i++) index(i) = i;
+		for (int sym = 0; sym < symmetries; sym++) {
+			board iso = index;
+			iso.rotate(sym % 4);
+			if (sym >= 4) iso.reflect_horizontal();
+			std::vector<int> mapped;
+			for (int i : cells) mapped.push_back(iso(i));
+			isomorphic.push_back(mapped);
+		}
+		net.emplace_back(size_t(1) << (2 * cells.size()));
+	}
+
+	/**
+	 * the raw sum of all lookups
+	 */
+	float value(const board& b) const {
+		float sum = 0;
+		if (mapped) {
+			for (size_t t = 0; t < isomorphic.size(); t++) sum += (*mapped)[t / symmetries][index(b, t)];
+		} else {
+			for (size_t t = 0; t < isomorphic.size(); t++) sum += net[t / symmetries][index(b, t)];
+		}
+		return sum;
+	}
+
+	/**
+	 * the estimated chance that the side to play wins
+	 */
+	float estimate(const board& b) const {
+		return 1.0f / (1.0f + std::exp(-value(b)));
+	}
+
+	/**
+	 * adjust the value of b by delta, which is spread over all lookups
+	 */
+	void update(const board& b, float delta) {
+		assert(!mapped);
+		float adjust = delta / isomorphic.size();
+		for (size_t t = 0; t < isomorphic.size(); t++) net[t / symmetries][index(b, t)] += adjust;
+	}
+
+	size_t lookups() const { return isomorphic.size(); }
+
+public:
+	/**
+	 * load the tables from either a quantized weight file, which is mapped, or a float weight file
+	 */
+	void load(const std::string& path) {
+		if (qweight::probe(path)) {
+			std::shared_ptr<qweight> file = std::make_shared<qweight>(path);
+			bool valid = file->kind() == "NTUP" && file->size() == net.size();
+			for (size_t i = 0; valid && i < net.size(); i++) valid = (*file)[i].size == table_size(i);
+			if (!valid) throw std::invalid_argument("invalid n-tuple weights: " + path);
+			mapped = file;
+			for (weight& w : net) w = weight(); // release the float tables
+			return;
+		}
+		std::ifstream in(path, std::ios::in | std::ios::binary);
+		uint32_t size = 0;
+		in.read(reinterpret_cast<char*>(&size), sizeof(size));
+		if (!in || size != net.size()) throw std::invalid_argument("invalid n-tuple weights: " + path);
+		for (size_t i = 0; i < net.size(); i++) {
+			in >> net[i];
+			if (!in || net[i].size() != table_size(i)) throw std::invalid_argument("invalid n-tuple weights: " + path);
+		}
+		mapped.reset();
+	}
+	void save(const std::string& path) const {
+		std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		uint32_t size = net.size();
+		out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		for (const weight& w : net) out << w;
+		if (!out) throw std::runtime_error("cannot write n-tuple weights: " + path);
+	}
+	void save_quantized(const std::string& path) const {
+		assert(!mapped);
+		qweight::save(path, "NTUP", net);
+	}
+
+protected:
+	size_t table_size(size_t i) const { return size_t(1) << (2 * isomorphic[i * symmetries].size()); }
+
+	/**
+	 * the table index of the t-th isomorphic tuple on b
+	 */
+	size_t index(const board& b, size_t t) const {
+		const board::cell* cells = &b[0][0];
+		unsigned own = b.info().who_take_turns;
+		// cell state to its relative state, for empty, black, white, and hollow
+		const unsigned relative[] = { 0u, own == board::black ? 1u : 2u, own == board::black ? 2u : 1u, 3u };
+		const std::vector<int>& tuple = isomorphic[t];
+		size_t idx = 0;
+		for (size_t k = 0; k < tuple.size(); k++)
+			idx |= size_t(relative[cells[tuple[k]] & 3u]) << (2 * k);
+		return idx;
+	}
+
+private:
+	std::vector<std::vector<int>> isomorphic;
+	std::vector<weight> net;
+	std::shared_ptr<qweight> mapped;
+};
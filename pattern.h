@@ -0,0 +1,276 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * pattern.h: Define the 3x3 patterns and the pattern-based rollout policy
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <array>
+#include <random>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include "board.h"
+#include "qweight.h"
+
+/**
+ * 3x3 pattern around an empty point, i.e., the 8 neighbors of the point
+ * each neighbor takes 2 bits: empty (0), black (1), white (2), or border (3)
+ * note that both the hollow cells and the cells out of the board are borders
+ *
+ * the neighbors are ordered as follows, where the center is the point itself
+ *   0 1 2      (x-1,y+1) (x,y+1) (x+1,y+1)
+ *   3 . 4  ==  (x-1,y  )    .    (x+1,y  )
+ *   5 6 7      (x-1,y-1) (x,y-1) (x+1,y-1)
+ */
+class pattern {
+public:
+	typedef uint16_t code;
+	enum { neighbors = 8, count = 1 << (2 * neighbors) };
+	typedef std::array<float, count> table;
+
+	static constexpr int dx(int k) { return k == 0 || k == 3 || k == 5 ? -1 : k == 2 || k == 4 || k == 7 ? 1 : 0; }
+	static constexpr int dy(int k) { return k < 3 ? 1 : k > 4 ? -1 : 0; }
+
+	/**
+	 * the 2-bit state of cell [x][y], cells out of the board are borders
+	 */
+	static unsigned cell(const board& b, int x, int y) {
+		if (x < 0 || x >= int(board::size_x) || y < 0 || y >= int(board::size_y)) return board::hollow;
+		return b[x][y] & 3u;
+	}
+
+	/**
+	 * the pattern code around [x][y]
+	 */
+	static code at(const board& b, int x, int y) {
+		code c = 0;
+		for (int k = 0; k < neighbors; k++)
+			c |= cell(b, x + dx(k), y + dy(k)) << (2 * k);
+		return c;
+	}
+
+	/**
+	 * the pattern with black and white exchanged, so that a table for black to play
+	 * can be applied to white to play
+	 */
+	static code swap(code c) {
+		code mask = c & (c >> 1) & 0x5555u; // borders have both bits set
+		code b = c & ~(c >> 1) & 0x5555u, w = (c >> 1) & ~c & 0x5555u;
+		return (mask * 3) | (b << 1) | w;
+	}
+
+	/**
+	 * the pattern under one of the 8 symmetries of the square
+	 * the symmetry is a clockwise rotation by (sym % 4) times, followed by a reflection if sym >= 4
+	 */
+	static code transform(code c, int sym) {
+		code t = 0;
+		for (int k = 0; k < neighbors; k++) {
+			int x = dx(k), y = dy(k);
+			for (int r = 0; r < sym % 4; r++) std::swap(x, y), y = -y;
+			if (sym >= 4) x = -x;
+			int to = 0;
+			while (dx(to) != x || dy(to) != y) to++;
+			t |= ((c >> (2 * k)) & 3u) << (2 * to);
+		}
+		return t;
+	}
+
+	/**
+	 * the representative of the patterns that are symmetric to c, i.e., the smallest one
+	 */
+	static code canonical(code c) {
+		static std::array<code, count> rep = []() {
+			std::array<code, count> rep;
+			for (size_t c = 0; c < count; c++) {
+				rep[c] = c;
+				for (int sym = 1; sym < 8; sym++) rep[c] = std::min(rep[c], transform(c, sym));
+			}
+			return rep;
+		}();
+		return rep[c];
+	}
+
+	/**
+	 * the rollout weights of each pattern when who is to play
+	 */
+	static const table& weights(unsigned who) { return tables()[who == board::white ? 1 : 0]; }
+
+	/**
+	 * replace the rollout weights, where w is indexed by the patterns for black to play
+	 * weights are kept positive so that every legal move remains playable
+	 */
+	static void assign(const table& w) {
+		fill(tables(), w);
+	}
+
+	/**
+	 * the binary weight file, as written by the learner
+	 *   "PAT3" | uint32 count | float weights[count]
+	 * where the weights are indexed by the patterns for black to play
+	 */
+	static void save(const std::string& path, const table& w) {
+		std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		uint32_t n = count;
+		out.write("PAT3", 4);
+		out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+		out.write(reinterpret_cast<const char*>(w.data()), sizeof(float) * count);
+		if (!out) throw std::runtime_error("cannot write pattern weights: " + path);
+	}
+	static void save_quantized(const std::string& path, const table& w) {
+		qweight::save(path, "PAT3", std::array<table, 1>{{ w }});
+	}
+
+	/**
+	 * load the weights from either a binary weight file or a quantized weight file
+	 */
+	static void load(const std::string& path) {
+		if (qweight::probe(path)) {
+			qweight file(path);
+			if (file.kind() != "PAT3" || file.size() != 1 || file[0].size != count)
+				throw std::invalid_argument("invalid pattern weights: " + path);
+			table w;
+			for (size_t c = 0; c < count; c++) w[c] = file[0][c];
+			assign(w);
+			return;
+		}
+		std::ifstream in(path, std::ios::in | std::ios::binary);
+		char magic[4] = {};
+		uint32_t n = 0;
+		table w;
+		in.read(magic, 4);
+		in.read(reinterpret_cast<char*>(&n), sizeof(n));
+		if (!in || std::string(magic, 4) != "PAT3" || n != count)
+			throw std::invalid_argument("invalid pattern weights: " + path);
+		in.read(reinterpret_cast<char*>(w.data()), sizeof(float) * count);
+		if (!in) throw std::invalid_argument("invalid pattern weights: " + path);
+		assign(w);
+	}
+
+protected:
+	/**
+	 * the tables are initialized with the default weights on the first access
+	 */
+	static std::array<table, 2>& tables() { static std::array<table, 2> t = default_tables(); return t; }
+
+	static void fill(std::array<table, 2>& t, const table& w) {
+		for (size_t c = 0; c < count; c++) {
+			t[0][c] = std::max(w[c], 1e-6f);
+			t[1][swap(c)] = std::max(w[c], 1e-6f);
+		}
+	}
+
+	/**
+	 * the default weights, crafted by hand for black to play
+	 * filling an own eye wastes a move that only the own side is able to play,
+	 * while playing next to opponent stones removes the liberties of the opponent
+	 */
+	static std::array<table, 2> default_tables() {
+		table w;
+		for (size_t c = 0; c < count; c++) {
+			int own = 0, opp = 0, border = 0, own_diag = 0;
+			for (int k = 0; k < neighbors; k++) {
+				unsigned v = (c >> (2 * k)) & 3u;
+				bool orth = dx(k) == 0 || dy(k) == 0;
+				if (orth && v == board::black) own++;
+				if (orth && v == board::white) opp++;
+				if (orth && v == board::hollow) border++;
+				if (!orth && v == board::black) own_diag++;
+			}
+			if (own + border == 4 || opp + border == 4) {
+				w[c] = 0.05f; // own eye, or opponent eye which is likely illegal
+			} else {
+				w[c] = 1.0f + 0.5f * opp + 0.25f * own_diag;
+				if (own >= 3) w[c] *= 0.5f;
+			}
+		}
+		std::array<table, 2> t;
+		fill(t, w);
+		return t;
+	}
+};
+
+/**
+ * rollout policy that samples moves proportionally to the weights of their 3x3 patterns
+ *
+ * the pattern codes of all points are computed once at reset, then updated incrementally
+ * when a stone is placed, since only the 8 neighbors of the placed stone are affected
+ * a point once found illegal is never tried again by the same side, since stones are never
+ * removed in NoGo and thus liberties only decrease
+ */
+class pattern_rollout {
+public:
+	enum { space = board::size_x * board::size_y };
+
+	void reset(const board& b) {
+		for (int i = 0; i < space; i++) {
+			board::point p(i);
+			codes[i] = pattern::at(b, p.x, p.y);
+		}
+		for (auto& mask : illegal) mask.fill(false);
+	}
+
+	/**
+	 * play a sampled legal move on b for the side to play
+	 * return false if there is no legal move
+	 */
+	bool step(board& b) {
+		unsigned who = b.info().who_take_turns;
+		const pattern::table& weights = pattern::weights(who);
+		std::array<bool, space>& skip = illegal[who == board::white ? 1 : 0];
+
+		std::array<float, space> w;
+		float sum = 0;
+		int candidates = 0;
+		for (int i = 0; i < space; i++) {
+			board::point p(i);
+			w[i] = (skip[i] || b[p.x][p.y] != board::empty) ? 0 : weights[codes[i]];
+			sum += w[i];
+			candidates += w[i] > 0;
+		}
+		while (candidates > 0) {
+			float r = std::uniform_real_distribution<float>(0, 1)(engine) * sum;
+			int i = -1;
+			float acc = 0;
+			for (int k = 0; k < space && acc <= r; k++) {
+				if (w[k] > 0) acc += w[i = k];
+			}
+			board::point p(i);
+			if (b.place(p.x, p.y, who) == board::legal) {
+				update(p, who);
+				return true;
+			}
+			skip[i] = true;
+			w[i] = 0;
+			candidates--;
+			sum = std::accumulate(w.begin(), w.end(), 0.0f);
+		}
+		return false;
+	}
+
+	std::default_random_engine engine;
+
+protected:
+	/**
+	 * refresh the codes of the neighbors of p, where p was empty and becomes who
+	 */
+	void update(const board::point& p, unsigned who) {
+		for (int k = 0; k < pattern::neighbors; k++) {
+			int x = p.x + pattern::dx(k), y = p.y + pattern::dy(k);
+			if (x < 0 || x >= int(board::size_x) || y < 0 || y >= int(board::size_y)) continue;
+			// p is the (7 - k)-th neighbor of [x][y]
+			codes[board::point(x, y).i] |= who << (2 * (7 - k));
+		}
+	}
+
+private:
+	std::array<pattern::code, space> codes;
+	std::array<std::array<bool, space>, 2> illegal;
+};
@@ -0,0 +1,137 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * perft.h: Count the leaves of the full game tree to a given depth
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <vector>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include "board.h"
+
+/**
+ * perft enumerates every move sequence of the given depth by board::get_legal_pts and board::place
+ * a position without legal moves before the depth is a terminal, which has no leaf
+ *
+ * the moves of the root are shared among the threads, and each thread may have its own cache,
+ * which maps the Zobrist key and the remaining depth of a position to its leaf count
+ */
+class perft {
+public:
+	struct result {
+		uint64_t leaves = 0; // the move sequences of the depth
+		uint64_t nodes = 0;  // the positions expanded, excluding those found in the cache
+		double elapsed = 0;  // in seconds
+	};
+
+	/**
+	 * cache is the number of entries per thread, rounded down to a power of 2, or 0 to disable the cache
+	 */
+	perft(size_t cache = 0, size_t threads = 1) : cache(cache), threads(std::max<size_t>(1, threads)) {
+		while (this->cache & (this->cache - 1)) this->cache &= this->cache - 1;
+	}
+
+	result run(const board& state, int depth) const {
+		result res;
+		auto start = std::chrono::steady_clock::now();
+		if (depth <= 1) {
+			res.leaves = depth == 1 ? board(state).get_legal_pts().size() : 1;
+			res.nodes = 1;
+		} else {
+			std::vector<board::point> moves = board(state).get_legal_pts();
+			std::atomic<size_t> next(0);
+			std::atomic<uint64_t> leaves(0), nodes(1);
+			std::vector<std::thread> workers;
+			for (size_t t = 0; t < std::min(threads, moves.size()); t++) {
+				workers.emplace_back([&]() {
+					std::vector<entry> table(cache);
+					uint64_t count = 0, visited = 0;
+					for (size_t i; (i = next++) < moves.size(); ) {
+						board after = state;
+						after.place(moves[i]);
+						count += search(after, hash(after), depth - 1, table, visited);
+					}
+					leaves += count;
+					nodes += visited;
+				});
+			}
+			for (std::thread& worker : workers) worker.join();
+			res.leaves = leaves;
+			res.nodes = nodes;
+		}
+		res.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return res;
+	}
+
+	/**
+	 * the Zobrist key of a position, including the side to play
+	 */
+	static uint64_t hash(const board& state) {
+		const board::cell* cells = &state[0][0];
+		uint64_t key = state.info().who_take_turns == board::white ? keys().turn : 0;
+		for (size_t i = 0; i < board::size_x * board::size_y; i++) {
+			if (cells[i] == board::black || cells[i] == board::white) key ^= keys().stone[cells[i] - 1][i];
+		}
+		return key;
+	}
+
+protected:
+	struct entry {
+		uint64_t key = 0;
+		uint64_t leaves = 0;
+		int depth = 0; // 0 for an empty entry
+	};
+
+	struct zobrist {
+		std::array<std::array<uint64_t, board::size_x * board::size_y>, 2> stone;
+		uint64_t turn;
+	};
+	static const zobrist& keys() {
+		static const zobrist z = []() {
+			zobrist z;
+			std::mt19937_64 engine(0);
+			for (auto& color : z.stone) for (uint64_t& k : color) k = engine();
+			z.turn = engine();
+			return z;
+		}();
+		return z;
+	}
+
+	/**
+	 * the leaves under a position, where the last ply is counted in bulk by get_legal_pts
+	 */
+	uint64_t search(board& state, uint64_t key, int depth, std::vector<entry>& table, uint64_t& nodes) const {
+		entry* slot = table.size() && depth > 1 ? &table[key & (table.size() - 1)] : nullptr;
+		if (slot && slot->depth == depth && slot->key == key) return slot->leaves;
+
+		nodes++;
+		std::vector<board::point> moves = state.get_legal_pts();
+		if (depth == 1) return moves.size();
+
+		uint64_t count = 0;
+		unsigned who = state.info().who_take_turns;
+		for (board::point move : moves) {
+			board after = state;
+			after.place(move);
+			count += search(after, key ^ keys().stone[who - 1][move.i] ^ keys().turn, depth - 1, table, nodes);
+		}
+		if (slot) {
+			slot->key = key;
+			slot->leaves = count;
+			slot->depth = depth;
+		}
+		return count;
+	}
+
+private:
+	size_t cache;
+	size_t threads;
+};
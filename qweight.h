@@ -0,0 +1,161 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * qweight.h: Quantized weight file, mapped into memory for reading
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * the quantized weight file is laid out as follows (little-endian)
+ *   header:    "NGQW" | uint32 version | char kind[4] | uint32 count
+ *   directory: count x { uint64 offset | uint64 size | float scale | uint32 reserved }
+ *   data:      count x int16 values[size], each starting at a 64-byte aligned offset
+ * where kind tells the evaluator of the tables, e.g., "PAT3" or "NTUP",
+ * and a table entry is restored by values[i] * scale
+ *
+ * the file is mapped read-only, so that processes loading the same file share the page cache,
+ * and nothing is parsed or copied at startup
+ */
+class qweight {
+public:
+	enum { version = 1, alignment = 64 };
+
+	struct table {
+		const int16_t* values;
+		size_t size;
+		float scale;
+		float operator [](size_t i) const { return values[i] * scale; }
+	};
+
+public:
+	qweight() : base(nullptr), length(0) {}
+	qweight(const std::string& path) : qweight() { map(path); }
+	qweight(const qweight&) = delete;
+	qweight& operator =(const qweight&) = delete;
+	~qweight() { unmap(); }
+
+	/**
+	 * check whether path is a quantized weight file, by its magic
+	 */
+	static bool probe(const std::string& path) {
+		char magic[4] = {};
+		std::ifstream(path, std::ios::in | std::ios::binary).read(magic, 4);
+		return std::string(magic, 4) == "NGQW";
+	}
+
+	void map(const std::string& path) {
+		unmap();
+		int fd = open(path.c_str(), O_RDONLY);
+		struct stat st;
+		if (fd == -1 || fstat(fd, &st) == -1) {
+			if (fd != -1) close(fd);
+			throw std::invalid_argument("cannot open quantized weights: " + path);
+		}
+		length = st.st_size;
+		void* addr = length ? mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+		close(fd);
+		if (addr == MAP_FAILED) throw std::invalid_argument("cannot map quantized weights: " + path);
+		base = static_cast<const char*>(addr);
+
+		uint32_t ver = 0, count = 0;
+		if (length >= 16) {
+			std::memcpy(&ver, base + 4, 4);
+			std::memcpy(&count, base + 12, 4);
+		}
+		if (length < 16 || std::string(base, 4) != "NGQW" || ver != version || length < 16 + count * 24ull) {
+			unmap();
+			throw std::invalid_argument("invalid quantized weights: " + path);
+		}
+		for (uint32_t i = 0; i < count; i++) {
+			const char* entry = base + 16 + i * 24;
+			uint64_t offset, size;
+			float scale;
+			std::memcpy(&offset, entry, 8);
+			std::memcpy(&size, entry + 8, 8);
+			std::memcpy(&scale, entry + 16, 4);
+			if (offset % alignment || offset > length || size > (length - offset) / sizeof(int16_t)) { // never overflows
+				unmap();
+				throw std::invalid_argument("invalid quantized weights: " + path);
+			}
+			tables.push_back({ reinterpret_cast<const int16_t*>(base + offset), size, scale });
+		}
+	}
+
+	std::string kind() const { return base ? std::string(base + 8, 4) : ""; }
+	size_t size() const { return tables.size(); }
+	const table& operator [](size_t i) const { return tables[i]; }
+
+public:
+	/**
+	 * quantize the tables and write them as a quantized weight file
+	 * each table is scaled by its own largest magnitude
+	 */
+	template<typename tables_type>
+	static void save(const std::string& path, const std::string& kind, const tables_type& src) {
+		std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		uint32_t ver = version, count = src.size();
+		out.write("NGQW", 4);
+		out.write(reinterpret_cast<const char*>(&ver), 4);
+		out.write((kind + "    ").data(), 4);
+		out.write(reinterpret_cast<const char*>(&count), 4);
+
+		uint64_t offset = align(16 + count * 24ull);
+		for (const auto& t : src) {
+			uint64_t size = t.size();
+			float scale = quantum(t);
+			uint32_t reserved = 0;
+			out.write(reinterpret_cast<const char*>(&offset), 8);
+			out.write(reinterpret_cast<const char*>(&size), 8);
+			out.write(reinterpret_cast<const char*>(&scale), 4);
+			out.write(reinterpret_cast<const char*>(&reserved), 4);
+			offset = align(offset + size * sizeof(int16_t));
+		}
+		for (const auto& t : src) {
+			while (out.tellp() % alignment) out.put(0);
+			float scale = quantum(t);
+			std::vector<int16_t> values(t.size());
+			for (size_t i = 0; i < t.size(); i++)
+				values[i] = int16_t(std::lround(std::max(-32767.0f, std::min(32767.0f, t[i] / scale))));
+			out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(int16_t));
+		}
+		if (!out) throw std::runtime_error("cannot write quantized weights: " + path);
+	}
+
+protected:
+	static uint64_t align(uint64_t offset) { return (offset + alignment - 1) / alignment * alignment; }
+
+	template<typename table_type>
+	static float quantum(const table_type& t) {
+		float peak = 0;
+		for (size_t i = 0; i < t.size(); i++) peak = std::max(peak, std::abs(float(t[i])));
+		return peak > 0 ? peak / 32767 : 1;
+	}
+
+	void unmap() {
+		if (base) munmap(const_cast<char*>(base), length);
+		base = nullptr;
+		length = 0;
+		tables.clear();
+	}
+
+private:
+	const char* base;
+	size_t length;
+	std::vector<table> tables;
+};
@@ -0,0 +1,164 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * selfplay.h: Generate training data by self-play, written as binary shards
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cerrno>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <sys/stat.h>
+#include "board.h"
+#include "action.h"
+#include "agent.h"
+
+/**
+ * a training record of a position, 248 bytes in size
+ *
+ *   cells:  the 81 cells in 1-d array style, empty (0), black (1), white (2), or hollow (3)
+ *   who:    the side to play, black (1) or white (2)
+ *   result: the final result for the side to play, win (1) or loss (-1)
+ *   visits: the root visit distribution of the search, scaled so that 65535 is all visits
+ */
+struct sample {
+	enum { cells_count = board::size_x * board::size_y };
+	uint8_t cells[cells_count];
+	uint8_t who;
+	int8_t result;
+	uint8_t reserved[1];
+	uint16_t visits[cells_count];
+	uint16_t padding;
+
+	sample() = default;
+	sample(const board& state, const std::array<float, cells_count>& dist) : who(state.info().who_take_turns), result(0), reserved(), padding() {
+		for (int i = 0; i < cells_count; i++) {
+			cells[i] = state(i);
+			visits[i] = uint16_t(dist[i] * 65535 + 0.5f);
+		}
+	}
+
+	/**
+	 * the record under one of the 8 symmetries of the board
+	 * the symmetry is a clockwise rotation by (sym % 4) times, followed by a reflection if sym >= 4
+	 * both the cells and the visits are transformed as boards, since a cell holds up to 32 bits
+	 */
+	sample transform(int sym) const {
+		board stones, counts;
+		for (int i = 0; i < cells_count; i++) {
+			stones(i) = cells[i];
+			counts(i) = visits[i];
+		}
+		stones.rotate(sym % 4);
+		counts.rotate(sym % 4);
+		if (sym >= 4) stones.reflect_horizontal(), counts.reflect_horizontal();
+		sample res = *this;
+		for (int i = 0; i < cells_count; i++) {
+			res.cells[i] = stones(i);
+			res.visits[i] = counts(i);
+		}
+		return res;
+	}
+};
+static_assert(sizeof(sample) == 248, "sample should be 248 bytes");
+
+/**
+ * self-play games played by worker threads, each writing its records to its own shard
+ * the shard of worker t is <dir>/shard-<seed>-<t>.bin, which is a plain array of samples
+ *
+ * the players of each worker are seeded from the base seed, so that runs with different seeds play
+ * different games into different shards, while a run with the same seed overwrites its own shards
+ */
+class selfplay {
+public:
+	selfplay(const std::string& black_args, const std::string& white_args, bool augment = false,
+	         unsigned seed = std::random_device()())
+		: black_args(black_args), white_args(white_args), augment(augment), seed(seed), games(0), records(0) {}
+
+	void generate(const std::string& dir, size_t total, size_t threads, size_t block = 0) {
+		if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+			throw std::runtime_error("cannot create directory: " + dir);
+		start = std::chrono::steady_clock::now();
+		std::atomic<size_t> claimed(0);
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < threads; t++) {
+			workers.emplace_back([&, t]() {
+				std::string path = dir + "/shard-" + std::to_string(seed) + "-" + std::to_string(t) + ".bin";
+				std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+				// the seeds are appended, so that they override the given ones for every worker
+				std::seed_seq seq{ seed, unsigned(t) };
+				unsigned seeds[2];
+				seq.generate(seeds, seeds + 2);
+				player black("name=black " + black_args + " role=black seed=" + std::to_string(seeds[0]));
+				player white("name=white " + white_args + " role=white seed=" + std::to_string(seeds[1]));
+				while (claimed++ < total) {
+					play(black, white, out);
+					size_t n = ++games;
+					if (block && n % block == 0) report(n);
+				}
+			});
+		}
+		for (std::thread& worker : workers) worker.join();
+		if (!block || games % block) report(games);
+	}
+
+protected:
+	void play(player& black, player& white, std::ofstream& out) {
+		std::vector<sample> game;
+		board state;
+		while (true) {
+			player& who = state.info().who_take_turns == board::black ? black : white;
+			action::place move = who.take_action(state);
+			sample rec(state, who.root_visits());
+			if (move.apply(state) != board::legal) break;
+			if (*std::max_element(rec.visits, rec.visits + sample::cells_count) == 0) {
+				rec.visits[move.position().i] = 65535; // the player did not search
+			}
+			game.push_back(rec);
+		}
+		// the side to play at the end has no legal move and loses
+		unsigned loser = state.info().who_take_turns;
+		for (sample& rec : game) {
+			rec.result = rec.who == loser ? -1 : 1;
+			for (int sym = 0; sym < (augment ? 8 : 1); sym++) {
+				sample aug = rec.transform(sym);
+				out.write(reinterpret_cast<const char*>(&aug), sizeof(aug));
+			}
+		}
+		out.flush();
+		records += game.size() * (augment ? 8 : 1);
+	}
+
+	void report(size_t n) {
+		std::lock_guard<std::mutex> lock(mutex);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << n << "\t";
+		std::cout << "records = " << records << ", ";
+		std::cout << "games/s = " << (n / elapsed.count()) << ", ";
+		std::cout << "records/s = " << (records / elapsed.count());
+		std::cout << std::endl;
+	}
+
+private:
+	std::string black_args;
+	std::string white_args;
+	bool augment;
+	unsigned seed;
+	std::atomic<size_t> games;
+	std::atomic<size_t> records;
+	std::chrono::steady_clock::time_point start;
+	std::mutex mutex;
+};
@@ -0,0 +1,110 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * sprt.h: Sequential probability ratio test and Elo estimation of matches
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * SPRT of H0: elo = elo0 against H1: elo = elo1, for the Elo difference of engine A over engine B
+ * since a game of NoGo never ends in a draw, the results are modeled as a binomial distribution
+ *
+ * the test is configured by arguments in the same style as the players, e.g.,
+ * "elo0=0 elo1=10 alpha=0.05 beta=0.05", where alpha and beta are the error rates of type I and II
+ */
+class sprt {
+public:
+	enum decision { undecided, accept_h0, accept_h1 };
+
+	sprt(const std::string& args = "") : elo0(0), elo1(10), alpha(0.05), beta(0.05), wins(0), losses(0) {
+		std::stringstream ss(args);
+		for (std::string pair; ss >> pair; ) {
+			std::string key = pair.substr(0, pair.find('='));
+			std::string value = pair.substr(pair.find('=') + 1);
+			if (key == "elo0") elo0 = std::stod(value);
+			else if (key == "elo1") elo1 = std::stod(value);
+			else if (key == "alpha") alpha = std::stod(value);
+			else if (key == "beta") beta = std::stod(value);
+			else throw std::invalid_argument("invalid sprt argument: " + pair);
+		}
+		if (!(elo0 < elo1) || !(alpha > 0 && alpha < 1) || !(beta > 0 && beta < 1))
+			throw std::invalid_argument("invalid sprt arguments: " + args);
+	}
+
+public:
+	/**
+	 * record the result of a game for engine A, which is ignored once the test is decided
+	 */
+	void add(bool win) {
+		if (status() != undecided) return;
+		(win ? wins : losses)++;
+	}
+
+	/**
+	 * the log-likelihood ratio of H1 over H0, and its bounds for accepting H0 and H1
+	 */
+	double llr() const {
+		double p0 = score(elo0), p1 = score(elo1);
+		return wins * std::log(p1 / p0) + losses * std::log((1 - p1) / (1 - p0));
+	}
+	double lower() const { return std::log(beta / (1 - alpha)); }
+	double upper() const { return std::log((1 - beta) / alpha); }
+
+	decision status() const {
+		double x = llr();
+		return x >= upper() ? accept_h1 : x <= lower() ? accept_h0 : undecided;
+	}
+
+	/**
+	 * the estimated Elo difference and its half-width of the 95% confidence interval,
+	 * where the score is clipped to half a game from 0 and 1 so that the estimation stays finite
+	 */
+	double elo() const { return elo_of(rate()); }
+	double margin() const {
+		size_t n = games();
+		if (n == 0) return INFINITY;
+		double s = rate(), d = 1.96 * std::sqrt(s * (1 - s) / n);
+		return (elo_of(std::min(s + d, 1 - 0.5 / n)) - elo_of(std::max(s - d, 0.5 / n))) / 2;
+	}
+
+	size_t games() const { return wins + losses; }
+
+	/**
+	 * the format is
+	 * 512    elo = 23.4 +- 30.1, llr = 1.23 [-2.94, 2.94]
+	 * followed by the decision if any, e.g., ", H1 accepted (elo >= 10)"
+	 */
+	friend std::ostream& operator <<(std::ostream& out, const sprt& test) {
+		out << test.games() << "\t";
+		out << "elo = " << test.elo() << " +- " << test.margin() << ", ";
+		out << "llr = " << test.llr() << " [" << test.lower() << ", " << test.upper() << "]";
+		if (test.status() == accept_h0) out << ", H0 accepted (elo <= " << test.elo0 << ")";
+		if (test.status() == accept_h1) out << ", H1 accepted (elo >= " << test.elo1 << ")";
+		return out;
+	}
+
+protected:
+	static double score(double elo) { return 1 / (1 + std::pow(10, -elo / 400)); }
+	static double elo_of(double score) { return -400 * std::log10(1 / score - 1); }
+
+	double rate() const {
+		size_t n = games();
+		if (n == 0) return 0.5;
+		return std::min(std::max(double(wins), 0.5), n - 0.5) / n;
+	}
+
+private:
+	double elo0, elo1;
+	double alpha, beta;
+	size_t wins, losses;
+};
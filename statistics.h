@@ -9,12 +9,18 @@
 
 #pragma once
 #include <deque>
+#include <vector>
+#include <string>
 #include <algorithm>
 #include <iostream>
 #include <sstream>
 #include "board.h"
 #include "action.h"
 #include "episode.h"
+#include "writer.h"
+#include "archive.h"
+#include "mapped.h"
+#include "histogram.h"
 
 class statistics {
 public:
@@ -23,13 +29,17 @@ public:
 	 * the block size of statistics
 	 * the limit of saving records
 	 *
-	 * note that total >= limit >= block
+	 * note that total >= limit >= block, and block >= 1 even if total is 0, e.g., when only loading
+	 * the limit may be below block when streaming (see stream), since the block is reported from running sums
+	 * if no block is given, it follows the total after loading, i.e., the loaded episodes are one block if none is played
 	 */
 	statistics(size_t total, size_t block = 0, size_t limit = 0)
 		: total(total),
-		  block(block ? block : total),
+		  block(std::max<size_t>(1, block ? block : total)),
 		  limit(limit ? limit : total),
-		  count(0) {}
+		  count(0),
+		  sized(block != 0),
+		  writer(nullptr) {}
 
 public:
 	/**
@@ -47,15 +57,45 @@ public:
 	 *  'ops = 125762 (132018|135377)': the average speed is 125762
 	 *                                  the average speed of black is 132018
 	 *                                  the average speed of white is 135377
+	 *
+	 * followed by the tail latency of the same games (in microseconds)
+	 * 1000   p50|p90|p99|max: game = 92031|118783|171007|233470, black = 1087|2047|5119|12003, white = 863|1791|4095|9124
+	 *
+	 * where the percentiles are of the duration of games, and of the thinking time of each move by black and white
+	 *
+	 * the last 'block' games are summed incrementally as they close, so that the default report takes
+	 * constant time, while the others rescan the last 'blk' games
 	 */
 	void show(size_t blk = 0) const {
 		size_t num = std::min(data.size(), blk ?: block);
+		bool running = (blk ?: block) == block; // the running sums cover the block even if data is trimmed by limit
+		if (running || num == recent.size()) {
+			report(count, sum);
+		} else {
+			tally res;
+			for (auto it = data.end() - num; it != data.end(); it++) res.add(*it);
+			report(count, res);
+		}
+		if ((running && lat.game.count() == block) || num == lat.game.count()) {
+			report(count, lat);
+		} else {
+			latency res;
+			for (auto it = data.end() - num; it != data.end(); it++) res.add(*it);
+			report(count, res);
+		}
+	}
+
+	/**
+	 * the aggregates of some episodes, from which a line of show is made
+	 */
+	struct tally {
+		size_t num = 0;
+		size_t BW = 0, WW = 0;
 		size_t sop = 0, Bop = 0, Wop = 0;
 		time_t sdu = 0, Bdu = 0, Wdu = 0;
-		size_t BW = 0, WW = 0;
-		auto it = data.end();
-		for (size_t i = 0; i < num; i++) {
-			auto& ep = *(--it);
+
+		void add(const episode& ep) {
+			num++;
 			if (ep.step() % 2 == 1) BW++;
 			else                    WW++;
 			sop += ep.step();
@@ -65,16 +105,72 @@ public:
 			Bdu += ep.time(action::black::type);
 			Wdu += ep.time(action::white::type);
 		}
+		tally& operator +=(const tally& t) {
+			num += t.num;
+			BW += t.BW; WW += t.WW;
+			sop += t.sop; Bop += t.Bop; Wop += t.Wop;
+			sdu += t.sdu; Bdu += t.Bdu; Wdu += t.Wdu;
+			return *this;
+		}
+		tally& operator -=(const tally& t) {
+			num -= t.num;
+			BW -= t.BW; WW -= t.WW;
+			sop -= t.sop; Bop -= t.Bop; Wop -= t.Wop;
+			sdu -= t.sdu; Bdu -= t.Bdu; Wdu -= t.Wdu;
+			return *this;
+		}
+	};
+
+	/**
+	 * the latency histograms of some episodes, from which the second line of show is made
+	 */
+	struct latency {
+		histogram game, black, white;
+
+		void add(const episode& ep) {
+			if (ep.time() < 0) return; // still ongoing
+			game.record(ep.time());
+			for (time_t t : ep.times(action::black::type)) black.record(std::max<time_t>(t, 0));
+			for (time_t t : ep.times(action::white::type)) white.record(std::max<time_t>(t, 0));
+		}
+		latency& operator +=(const latency& t) {
+			game += t.game;
+			black += t.black;
+			white += t.white;
+			return *this;
+		}
+		void clear() {
+			game.clear();
+			black.clear();
+			white.clear();
+		}
+	};
 
-		std::cout << count << "\t";
-		std::cout << "win = " << (BW * 100.0 / num) << "%"
-		          <<      "|" << (WW * 100.0 / num) << "%, ";
-		std::cout << "op = "  << (sop * 1.0 / num)
-		          <<     " (" << (Bop * 1.0 / num)
-		          <<      "|" << (Wop * 1.0 / num) << "), ";
-		std::cout << "ops = " << (sop * 1000.0 / sdu)
-		          <<     " (" << (Bop * 1000.0 / Bdu)
-		          <<      "|" << (Wop * 1000.0 / Wdu) << ")";
+	static void report(size_t n, const latency& lat, std::ostream& out = std::cout) {
+		if (!lat.game.count()) return;
+		auto tail = [](const histogram& h) -> std::string {
+			return std::to_string(h.percentile(50)) + "|" + std::to_string(h.percentile(90)) + "|"
+			     + std::to_string(h.percentile(99)) + "|" + std::to_string(h.max());
+		};
+		out << n << "\t";
+		out << "p50|p90|p99|max: ";
+		out << "game = "  << tail(lat.game)  << ", ";
+		out << "black = " << tail(lat.black) << ", ";
+		out << "white = " << tail(lat.white);
+		out << std::endl;
+	}
+
+	static void report(size_t n, const tally& t) {
+		size_t num = t.num;
+		std::cout << n << "\t";
+		std::cout << "win = " << (t.BW * 100.0 / num) << "%"
+		          <<      "|" << (t.WW * 100.0 / num) << "%, ";
+		std::cout << "op = "  << (t.sop * 1.0 / num)
+		          <<     " (" << (t.Bop * 1.0 / num)
+		          <<      "|" << (t.Wop * 1.0 / num) << "), ";
+		std::cout << "ops = " << (t.sop * 1000000.0 / t.sdu)
+		          <<     " (" << (t.Bop * 1000000.0 / t.Bdu)
+		          <<      "|" << (t.Wop * 1000000.0 / t.Wdu) << ")";
 		std::cout << std::endl;
 	}
 
@@ -98,7 +194,38 @@ public:
 
 	void close_episode(const std::string& flag = "") {
 		data.back().close_episode(flag);
-		if (count % block == 0) show();
+		slide(data.back());
+		lat.add(data.back());
+		if (writer) writer->write(data.back());
+		if (count % block == 0) {
+			show();
+			close_block();
+		}
+	}
+
+	/**
+	 * add an episode that was played elsewhere, e.g., by parallel games
+	 */
+	void add_episode(const episode& ep) {
+		if (count++ >= limit) data.pop_front();
+		data.push_back(ep);
+		slide(data.back());
+		lat.add(data.back());
+		if (writer) writer->write(data.back());
+		if (count % block == 0) {
+			show();
+			close_block();
+		}
+	}
+
+	/**
+	 * write each episode to the writer as it closes, or stop if nullptr
+	 * the latency of each block is passed to the writer as well, which writes them all after the episodes when closed
+	 * note that the limit then bounds only the episodes kept in memory
+	 */
+	void stream(episode_writer* w) {
+		writer = w;
+		for (size_t i = 0; writer && i < tails.size(); i++) writer->note(tails[i]);
 	}
 
 	episode& at(size_t i) {
@@ -113,25 +240,196 @@ public:
 	size_t step() const {
 		return count;
 	}
+	size_t size() const {
+		return data.size();
+	}
 
+	/**
+	 * the episodes are saved one per line, followed by an empty line and the tail latency of each block,
+	 * where the episodes are parsed up to the first empty line, and the latency after it is kept as is
+	 * note that the latency of every block is saved, even if its episodes are beyond the limit
+	 */
 	friend std::ostream& operator <<(std::ostream& out, const statistics& stat) {
 		for (const episode& rec : stat.data) out << rec << std::endl;
+		if (stat.tails.size()) out << std::endl;
+		for (const std::string& line : stat.tails) out << line;
 		return out;
 	}
 	friend std::istream& operator >>(std::istream& in, statistics& stat) {
-		for (std::string line; std::getline(in, line) && line.size(); ) {
+		std::string line;
+		while (std::getline(in, line) && line.size()) {
 			stat.data.emplace_back();
 			std::stringstream(line) >> stat.data.back();
 		}
-		stat.total = std::max(stat.total, stat.data.size());
-		stat.count = stat.data.size();
+		while (std::getline(in, line)) {
+			if (line.size()) stat.tails.push_back(line + '\n');
+		}
+		stat.loaded();
 		return in;
 	}
 
+	/**
+	 * load all the episodes of a text file, as operator >> but parsed by the given threads
+	 * the file is mapped and split at line boundaries, and each thread parses its chunk in place,
+	 * i.e., the lines of each chunk are counted first, so that the storage is allocated only once
+	 */
+	void load(const mapped_file& in, size_t threads) {
+		std::vector<mapped_file::chunk> chunks = in.split(threads);
+		std::vector<size_t> offset(chunks.size() + 1, data.size());
+		mapped_file::parallel(chunks.size(), [&](size_t i) {
+			size_t lines = 0;
+			mapped_file::for_each_line(chunks[i], [&](const char*, const char*) { lines++; });
+			offset[i + 1] = lines;
+		});
+		for (size_t i = 0; i < chunks.size(); i++) offset[i + 1] += offset[i];
+		data.resize(offset.back());
+		mapped_file::parallel(chunks.size(), [&](size_t i) {
+			auto it = data.begin() + offset[i];
+			std::istringstream line;
+			mapped_file::for_each_line(chunks[i], [&](const char* begin, const char* end) {
+				line.str(std::string(begin, end));
+				line.clear();
+				line >> *(it++);
+			});
+		});
+		mapped_file::for_each_line(in.tail(), [&](const char* begin, const char* end) {
+			tails.push_back(std::string(begin, end) + '\n');
+		});
+		loaded();
+	}
+
+	/**
+	 * load all the episodes of a binary archive, as reading the text format by operator >>
+	 */
+	void load(const archive::reader& in, size_t threads = 1) {
+		size_t base = data.size(), num = in.size();
+		threads = std::max<size_t>(1, std::min(threads, num));
+		data.resize(base + num);
+		mapped_file::parallel(threads, [&](size_t i) {
+			for (size_t n = num * i / threads; n < num * (i + 1) / threads; n++) in.read(n, data[base + n]);
+		});
+		loaded();
+	}
+
+	/**
+	 * summarize a text file as summary() after loading it, without keeping the episodes
+	 */
+	static void summarize(const mapped_file& in, size_t threads) {
+		std::vector<mapped_file::chunk> chunks = in.split(threads);
+		std::vector<tally> partial(chunks.size());
+		std::vector<latency> tail(chunks.size());
+		mapped_file::parallel(chunks.size(), [&](size_t i) {
+			std::istringstream line;
+			episode ep;
+			mapped_file::for_each_line(chunks[i], [&](const char* begin, const char* end) {
+				line.str(std::string(begin, end));
+				line.clear();
+				line >> ep;
+				partial[i].add(ep);
+				tail[i].add(ep);
+			});
+		});
+		merge(partial, tail);
+	}
+
+	/**
+	 * summarize a binary archive as summary() after loading it, without keeping the episodes
+	 */
+	static void summarize(const archive::reader& in, size_t threads) {
+		size_t num = in.size();
+		threads = std::max<size_t>(1, std::min(threads, num));
+		std::vector<tally> partial(threads);
+		std::vector<latency> tail(threads);
+		mapped_file::parallel(threads, [&](size_t i) {
+			episode ep;
+			for (size_t n = num * i / threads; n < num * (i + 1) / threads; n++) {
+				in.read(n, ep);
+				partial[i].add(ep);
+				tail[i].add(ep);
+			}
+		});
+		merge(partial, tail);
+	}
+
+protected:
+	/**
+	 * report the summary of the partial aggregates of summarize
+	 */
+	static void merge(const std::vector<tally>& partial, const std::vector<latency>& tail) {
+		tally sum;
+		latency lat;
+		for (const tally& t : partial) sum += t;
+		for (const latency& t : tail) lat += t;
+		report(sum.num, sum);
+		report(sum.num, lat);
+	}
+
 private:
+	/**
+	 * keep the latency of the block just closed, which is also passed to the writer if streaming
+	 */
+	void close_block() {
+		std::ostringstream line;
+		report(count, lat, line);
+		tails.push_back(line.str());
+		if (writer) writer->note(tails.back());
+		lat.clear();
+	}
+
+	/**
+	 * settle the counters after loading, where the latency of each full block is rebuilt from the episodes
+	 * only if the file has none, e.g., an archive
+	 */
+	void loaded() {
+		total = std::max(total, data.size());
+		if (!sized) block = std::max<size_t>(1, total);
+		count = data.size();
+		refill();
+		if (tails.size()) return;
+		latency part;
+		for (size_t i = 0; i < data.size(); i++) {
+			part.add(data[i]);
+			if ((i + 1) % block) continue;
+			std::ostringstream line;
+			report(i + 1, part, line);
+			tails.push_back(line.str());
+			part.clear();
+		}
+	}
+
+	/**
+	 * move the window of the last 'block' games forward by a closed episode
+	 */
+	void slide(const episode& ep) {
+		recent.emplace_back();
+		recent.back().add(ep);
+		sum += recent.back();
+		if (recent.size() > block) {
+			sum -= recent.front();
+			recent.pop_front();
+		}
+	}
+
+	/**
+	 * rebuild the window from the stored episodes, e.g., after loading
+	 */
+	void refill() {
+		recent.clear();
+		sum = {};
+		for (auto it = data.end() - std::min(data.size(), block); it != data.end(); it++) slide(*it);
+		lat.clear();
+		for (auto it = data.end() - std::min(data.size(), count % block); it != data.end(); it++) lat.add(*it);
+	}
+
 	size_t total;
 	size_t block;
 	size_t limit;
 	size_t count;
+	bool sized; // whether the block is given
 	std::deque<episode> data;
+	std::deque<tally> recent; // the tally of each of the last 'block' games
+	tally sum; // the sum of recent
+	latency lat; // the latency of the games since the last block
+	std::vector<std::string> tails; // the latency line of each closed block, saved after the episodes
+	episode_writer* writer;
 };
@@ -0,0 +1,139 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * trace.h: Record timestamped spans in the Chrome trace event format
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <fstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+
+/**
+ * the trace is disabled unless a file is opened, in which case the spans are written to it at exit,
+ * as a JSON array of complete events that can be loaded by chrome://tracing or https://ui.perfetto.dev/
+ *
+ * each thread appends to its own buffer, so that recording takes no lock
+ * the buffers are owned by the trace rather than the threads, thus the spans of finished threads are kept
+ */
+class trace {
+public:
+	typedef std::chrono::steady_clock clock;
+
+	/**
+	 * a span from its construction to its destruction
+	 */
+	class span {
+	public:
+		span(const char* name, const char* category = "search") : name(name), category(category) {
+			if (enabled()) start = clock::now();
+		}
+		span(const std::string& name, const char* category = "search") : span(name.c_str(), category) {
+			if (enabled()) label = name; // the name may not outlive the span
+		}
+		~span() {
+			if (enabled()) record(label.size() ? label.c_str() : name, category, start, clock::now());
+		}
+	private:
+		const char* name;
+		const char* category;
+		std::string label;
+		clock::time_point start;
+	};
+
+	static void open(const std::string& path) {
+		state& s = global();
+		s.path = path;
+		s.origin = clock::now();
+		s.enabled = true;
+		std::atexit(flush);
+	}
+
+	static bool enabled() { return global().enabled; }
+
+	/**
+	 * record a span of the calling thread, where category is a static string
+	 */
+	static void record(const char* name, const char* category, clock::time_point start, clock::time_point end) {
+		if (!enabled()) return;
+		thread_local buffer* local = nullptr;
+		if (local == nullptr) local = attach();
+		local->events.push_back({ name, category, start, end });
+	}
+
+	/**
+	 * write all the recorded spans, called at exit
+	 */
+	static void flush() {
+		state& s = global();
+		if (!s.enabled) return;
+		s.enabled = false;
+		std::lock_guard<std::mutex> lock(s.mutex);
+		std::ofstream out(s.path, std::ios::out | std::ios::trunc);
+		out << "[" << std::endl;
+		bool first = true;
+		for (const buffer& buf : s.buffers) {
+			for (const event& e : buf.events) {
+				out << (first ? "" : ",\n");
+				out << "{\"name\":\"" << escape(e.name) << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",";
+				out << "\"ts\":" << micros(s.origin, e.start) << ",\"dur\":" << micros(e.start, e.end) << ",";
+				out << "\"pid\":1,\"tid\":" << buf.tid << "}";
+				first = false;
+			}
+		}
+		out << std::endl << "]" << std::endl;
+	}
+
+protected:
+	struct event {
+		std::string name;
+		const char* category;
+		clock::time_point start, end;
+	};
+	struct buffer {
+		size_t tid;
+		std::vector<event> events;
+	};
+	struct state {
+		std::atomic<bool> enabled{false};
+		std::string path;
+		clock::time_point origin;
+		std::list<buffer> buffers;
+		std::mutex mutex;
+	};
+
+	static state& global() {
+		static state s;
+		return s;
+	}
+
+	static buffer* attach() {
+		state& s = global();
+		std::lock_guard<std::mutex> lock(s.mutex);
+		s.buffers.push_back({ s.buffers.size() + 1, {} });
+		return &s.buffers.back();
+	}
+
+	static double micros(clock::time_point from, clock::time_point to) {
+		return std::chrono::duration<double, std::micro>(to - from).count();
+	}
+
+	static std::string escape(const std::string& text) {
+		std::string res;
+		for (char c : text) {
+			if (c == '"' || c == '\\') res += '\\';
+			if (c >= 0 && c < ' ') continue;
+			res += c;
+		}
+		return res;
+	}
+};
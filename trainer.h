@@ -0,0 +1,122 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * trainer.h: Temporal difference learning of the n-tuple network by self-play
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include "board.h"
+#include "ntuple.h"
+
+/**
+ * TD(0) trainer of the n-tuple network by self-play across threads
+ *
+ * the network is shared by all threads and updated without locks (Hogwild style),
+ * since concurrent updates rarely touch the same entries and a lost update is harmless
+ *
+ * every move is chosen greedily by the network with an epsilon chance of a random move,
+ * and the value of the state before the move is updated toward the value after the move,
+ * where the side to play with no legal move loses
+ */
+class td_trainer {
+public:
+	td_trainer(ntuple& net, float alpha = 0.1f, float epsilon = 0.1f, unsigned seed = 0)
+		: net(net), alpha(alpha), epsilon(epsilon), seed(seed), games(0), updates(0) {}
+
+	/**
+	 * play total games of self-play with the given number of threads
+	 * the network is saved to path every checkpoint games, and at the end
+	 */
+	void train(size_t total, size_t threads, const std::string& path = "", size_t checkpoint = 0) {
+		start = std::chrono::steady_clock::now();
+		std::atomic<size_t> claimed(0);
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < threads; t++) {
+			workers.emplace_back([&, t]() {
+				std::default_random_engine engine(seed + t);
+				while (claimed++ < total) {
+					play(engine);
+					size_t n = ++games;
+					if (checkpoint && n % checkpoint == 0) report(n, path);
+				}
+			});
+		}
+		for (std::thread& worker : workers) worker.join();
+		if (!checkpoint || games % checkpoint) report(games, path);
+	}
+
+protected:
+	/**
+	 * play a game of self-play and update the network along the way
+	 */
+	void play(std::default_random_engine& engine) {
+		std::uniform_real_distribution<float> chance(0, 1);
+		board state;
+		float value = net.estimate(state);
+		while (true) {
+			// evaluate all afterstates, in the view of the opponent
+			board best;
+			float best_value = 2;
+			int legal = 0;
+			bool explore = chance(engine) < epsilon;
+			for (int i = 0; i < board::size_x * board::size_y; i++) {
+				board after = state;
+				if (after.place(board::point(i)) != board::legal) continue;
+				float v = net.estimate(after);
+				legal++;
+				// reservoir sampling for exploration, otherwise keep the worst for the opponent
+				if (explore ? std::uniform_int_distribution<int>(1, legal)(engine) == 1 : v < best_value) {
+					best = after;
+					best_value = v;
+				}
+			}
+			float target = legal ? 1 - best_value : 0;
+			net.update(state, alpha * (target - value));
+			updates++;
+			if (!legal) break;
+			state = best;
+			value = best_value;
+		}
+	}
+
+	/**
+	 * the checkpoint is saved to path.tmp and then renamed over path,
+	 * so that an interrupted save never leaves a truncated checkpoint behind
+	 */
+	void report(size_t n, const std::string& path) {
+		std::lock_guard<std::mutex> lock(mutex);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (path.size()) {
+			net.save(path + ".tmp");
+			if (std::rename((path + ".tmp").c_str(), path.c_str()) != 0) throw std::runtime_error("cannot rename to " + path);
+		}
+		std::cout << n << "\t";
+		std::cout << "games/s = " << (n / elapsed.count()) << ", ";
+		std::cout << "updates/s = " << (updates / elapsed.count());
+		if (path.size()) std::cout << ", saved to " << path;
+		std::cout << std::endl;
+	}
+
+private:
+	ntuple& net;
+	float alpha;
+	float epsilon;
+	unsigned seed;
+	std::atomic<size_t> games;
+	std::atomic<size_t> updates;
+	std::chrono::steady_clock::time_point start;
+	std::mutex mutex;
+};
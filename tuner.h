@@ -0,0 +1,139 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * tuner.h: Tune numeric player arguments by SPSA with parallel self-play games
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "arena.h"
+
+/**
+ * simultaneous perturbation stochastic approximation over a declared set of numeric player arguments
+ *
+ * the parameters are declared as "name=start:min:max:step", e.g., "c=0.25:0:1:0.05 T=1000:100:5000:200",
+ * where step is the perturbation at the first iteration, and a parameter whose start, min, and max are
+ * all integers is rounded when passed to the players
+ *
+ * at iteration k, every parameter is perturbed by +-c_k in a random direction, where c_k = step / k^0.101,
+ * then a batch of games is played between the plus and the minus players with colors alternated,
+ * and each parameter moves by r * a_k * c_k * (plus wins - minus wins) in its direction,
+ * where a_k = ((A + 1) / (A + k))^0.602 and A is 10% of the iterations
+ */
+class spsa {
+public:
+	struct param {
+		std::string name;
+		double value, min, max, step;
+		bool integer;
+	};
+
+	spsa(const std::string& base_args, const std::string& params, double r = 0.05, unsigned seed = 0)
+		: base_args(base_args), r(r), engine(seed) {
+		std::stringstream ss(params);
+		for (std::string decl; ss >> decl; ) {
+			std::vector<std::string> fields;
+			std::stringstream fs(decl.substr(decl.find('=') + 1));
+			for (std::string f; std::getline(fs, f, ':'); fields.push_back(f));
+			if (decl.find('=') == std::string::npos || fields.size() != 4)
+				throw std::invalid_argument("invalid tuning parameter: " + decl);
+			param p = { decl.substr(0, decl.find('=')), std::stod(fields[0]), std::stod(fields[1]),
+				std::stod(fields[2]), std::stod(fields[3]), true };
+			for (size_t i = 0; i < 3; i++) p.integer &= fields[i].find_first_of(".eE") == std::string::npos;
+			if (!(p.min <= p.value && p.value <= p.max && p.step > 0))
+				throw std::invalid_argument("invalid tuning parameter: " + decl);
+			theta.push_back(p);
+		}
+		if (theta.empty()) throw std::invalid_argument("no tuning parameter: " + params);
+	}
+
+	/**
+	 * run the given number of iterations, each with a batch of games played on jobs threads,
+	 * and print the trajectory of the parameters after every iteration
+	 */
+	void tune(size_t iterations, size_t batch, size_t jobs) {
+		batch = std::max<size_t>(2, batch + batch % 2);
+		double A = 0.1 * iterations;
+		arena pool(jobs, engine());
+		for (size_t k = 1; k <= iterations; k++) {
+			double ck = 1 / std::pow(k, 0.101), ak = std::pow((A + 1) / (A + k), 0.602);
+			std::vector<int> delta(theta.size());
+			std::vector<double> plus(theta.size()), minus(theta.size());
+			for (size_t i = 0; i < theta.size(); i++) {
+				delta[i] = std::bernoulli_distribution(0.5)(engine) ? 1 : -1;
+				plus[i] = clip(i, theta[i].value + delta[i] * theta[i].step * ck);
+				minus[i] = clip(i, theta[i].value - delta[i] * theta[i].step * ck);
+			}
+			std::string plus_args = args(plus), minus_args = args(minus);
+
+			// the plus player plays black in even games and white in odd games
+			int result = 0;
+			pool.play(batch, [&](size_t i) {
+				return i % 2 == 0 ? std::make_pair(plus_args, minus_args) : std::make_pair(minus_args, plus_args);
+			}, [&](const episode& game, size_t i) {
+				bool black_wins = game.step() % 2 == 1;
+				result += black_wins == (i % 2 == 0) ? 1 : -1;
+				return true;
+			});
+
+			for (size_t i = 0; i < theta.size(); i++) {
+				theta[i].value = clip(i, theta[i].value + r * ak * ck * theta[i].step * result * delta[i]);
+			}
+			report(k, result);
+		}
+	}
+
+	const std::vector<param>& parameters() const { return theta; }
+
+	/**
+	 * the player arguments with the current parameters
+	 */
+	std::string args() const {
+		std::vector<double> values;
+		for (const param& p : theta) values.push_back(p.value);
+		return args(values);
+	}
+
+protected:
+	double clip(size_t i, double value) const {
+		return std::min(std::max(value, theta[i].min), theta[i].max);
+	}
+
+	std::string args(const std::vector<double>& values) const {
+		std::stringstream ss;
+		ss << base_args;
+		for (size_t i = 0; i < theta.size(); i++) {
+			ss << " " << theta[i].name << "=";
+			if (theta[i].integer) ss << std::llround(values[i]);
+			else ss << values[i];
+		}
+		return ss.str();
+	}
+
+	/**
+	 * the format is
+	 * 12     result = +4, c = 0.2631, T = 1180
+	 */
+	void report(size_t k, int result) const {
+		std::cout << k << "\t";
+		std::cout << "result = " << (result > 0 ? "+" : "") << result;
+		for (const param& p : theta) std::cout << ", " << p.name << " = " << p.value;
+		std::cout << std::endl;
+	}
+
+private:
+	std::string base_args;
+	std::vector<param> theta;
+	double r;
+	std::default_random_engine engine;
+};
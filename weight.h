@@ -0,0 +1,63 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * weight.h: Lookup table template for n-tuple network
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+class weight {
+public:
+	weight() {}
+	weight(size_t len) : value(len) {}
+	weight(weight&& f) : value(std::move(f.value)) {}
+	weight(const weight& f) = default;
+
+	weight& operator =(const weight& f) = default;
+	float& operator[] (size_t i) { return value[i]; }
+	const float& operator[] (size_t i) const { return value[i]; }
+	size_t size() const { return value.size(); }
+
+public:
+	friend std::ostream& operator <<(std::ostream& out, const weight& w) {
+		auto& value = w.value;
+		uint64_t size = value.size();
+		out.write(reinterpret_cast<const char*>(&size), sizeof(uint64_t));
+		out.write(reinterpret_cast<const char*>(value.data()), sizeof(float) * size);
+		return out;
+	}
+	/**
+	 * the size is checked against the rest of the stream before allocating, if the stream is seekable,
+	 * so that a corrupted size fails the stream instead of allocating a huge table
+	 */
+	friend std::istream& operator >>(std::istream& in, weight& w) {
+		auto& value = w.value;
+		uint64_t size = 0;
+		in.read(reinterpret_cast<char*>(&size), sizeof(uint64_t));
+		if (!in) return in;
+		std::streampos here = in.tellg();
+		if (here != std::streampos(-1) && in.seekg(0, std::ios::end)) {
+			uint64_t left = in.tellg() - here;
+			in.seekg(here);
+			if (size > left / sizeof(float)) {
+				in.setstate(std::ios::failbit);
+				return in;
+			}
+		} else {
+			in.clear(); // not seekable, so the size is trusted
+		}
+		value.resize(size);
+		in.read(reinterpret_cast<char*>(value.data()), sizeof(float) * size);
+		return in;
+	}
+
+protected:
+	std::vector<float> value;
+};
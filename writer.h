@@ -0,0 +1,150 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * writer.h: Append episodes to a file as they close, written by a background thread
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "episode.h"
+
+/**
+ * the episodes are written one per line in the same format as saving the statistics
+ *
+ * an episode is formatted by the caller and queued, then the background thread writes everything
+ * queued so far by a single write, so that the games are never blocked by the disk
+ * with sync = N > 0, the file is also fsync'ed every N episodes and when closed,
+ * otherwise the data is left to the page cache, which survives a crash of the process but not of the system
+ *
+ * the lines noted by note, e.g., the latency of each block, are written after an empty line when closed,
+ * so that the file is the same as saving the statistics at exit
+ *
+ * the first failed write is latched: the file is trimmed back to its last complete episode,
+ * nothing is written after it, and the error is reported when closed
+ */
+class episode_writer {
+public:
+	episode_writer(const std::string& path, bool append = false, size_t sync = 0)
+		: path(path), sync(sync), queued(0), closing(false), error(0) {
+		fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644);
+		if (fd < 0) throw std::runtime_error("cannot open " + path);
+		written = lseek(fd, 0, SEEK_END);
+		worker = std::thread(&episode_writer::run, this);
+	}
+	episode_writer(const episode_writer&) = delete;
+	episode_writer& operator =(const episode_writer&) = delete;
+
+	~episode_writer() {
+		close();
+	}
+
+	/**
+	 * write all the queued episodes, then the noted lines, and close the file, or report the latched error
+	 * return whether everything was written
+	 */
+	bool close() {
+		if (fd < 0) return !error;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closing = true;
+		}
+		ready.notify_one();
+		worker.join();
+		if (notes.size() && !error) put("\n" + notes);
+		if (sync) fsync(fd);
+		::close(fd);
+		fd = -1;
+		if (error) std::cerr << "failed to write episodes to " << path << ": " << std::strerror(error)
+		                     << ", the file ends at the last complete episode" << std::endl;
+		return !error;
+	}
+
+	void write(const episode& ep) {
+		if (error) return;
+		std::ostringstream line;
+		line << ep << std::endl;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pending += line.str();
+			queued++;
+		}
+		ready.notify_one();
+	}
+
+	/**
+	 * keep a line to be written after the episodes when closed
+	 */
+	void note(const std::string& line) {
+		std::lock_guard<std::mutex> lock(mutex);
+		notes += line;
+	}
+
+protected:
+	void run() {
+		size_t unsynced = 0;
+		std::string buffer;
+		while (true) {
+			size_t episodes;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				ready.wait(lock, [this]() { return pending.size() || closing; });
+				if (pending.empty()) return; // closing with nothing left
+				buffer.swap(pending);
+				episodes = queued;
+				queued = 0;
+			}
+			if (!error) put(buffer);
+			buffer.clear();
+			unsynced += episodes;
+			if (sync && unsynced >= sync) {
+				fsync(fd);
+				unsynced = 0;
+			}
+		}
+	}
+
+	/**
+	 * write the buffer completely, or latch the error and drop whatever of it was written
+	 */
+	void put(const std::string& buffer) {
+		for (size_t done = 0; done < buffer.size(); ) {
+			ssize_t n = ::write(fd, buffer.data() + done, buffer.size() - done);
+			if (n < 0 && errno == EINTR) continue;
+			if (n < 0) {
+				error = errno;
+				if (ftruncate(fd, written) != 0) std::cerr << "cannot trim the partial episode of " << path << std::endl;
+				return;
+			}
+			done += n;
+		}
+		written += buffer.size();
+	}
+
+private:
+	std::string path;
+	int fd;
+	size_t sync;
+	std::string pending;
+	std::string notes;
+	size_t queued;
+	bool closing;
+	off_t written; // the length of the file up to the last complete write
+	std::atomic<int> error; // the errno of the first failed write, or 0
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::thread worker;
+};